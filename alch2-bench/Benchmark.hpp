@@ -0,0 +1,135 @@
+#pragma once
+/**
+ * @file	Benchmark.hpp
+ * @author	radj307
+ * @brief	Minimal microbenchmark runner used by alch2-bench.
+ */
+#include <sysarch.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+	/**
+	 * @brief		Prevents the compiler from optimizing away the computation of the given value.
+	 * @param value	Any value.
+	 */
+	template<typename T>
+	inline void do_not_optimize(T const& value)
+	{
+	#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+	#else
+		static volatile const void* sink;
+		sink = &value;
+	#endif
+	}
+
+	/// @brief	A single benchmark case. The callback must perform exactly `iterations` repetitions of the operation being measured.
+	struct Case {
+		std::string name;
+		std::function<void(std::size_t iterations)> run;
+	};
+
+	struct Result {
+		std::string name;
+		std::size_t iterations;
+		double median_ns;
+		double min_ns;
+	};
+
+	class Runner {
+		using clock = std::chrono::steady_clock;
+
+		std::vector<Case> cases;
+
+		static double time_ns(Case const& c, std::size_t const iterations)
+		{
+			const auto start{ clock::now() };
+			c.run(iterations);
+			return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+		}
+
+	public:
+		/// @brief	The minimum total time to spend measuring each case.
+		std::chrono::milliseconds minTime{ 250 };
+		/// @brief	The number of samples to take for each case; the median and minimum are reported.
+		std::size_t samples{ 7 };
+
+		void add(std::string const& name, std::function<void(std::size_t)> const& run)
+		{
+			cases.emplace_back(Case{ name, run });
+		}
+
+		/**
+		 * @brief			Runs all cases whose name contains the given filter string.
+		 * @param filter	When non-empty, only cases whose name contains this string are run.
+		 * @returns			The results of each case that was run, in the order they were added.
+		 */
+		std::vector<Result> run(std::string const& filter = {}) const
+		{
+			std::vector<Result> results;
+			const double sampleTarget_ns{ std::chrono::duration<double, std::nano>(minTime).count() / $c(double, samples) };
+
+			for (const auto& c : cases) {
+				if (!filter.empty() && c.name.find(filter) == std::string::npos)
+					continue;
+
+				// calibrate the number of iterations so that each sample takes roughly sampleTarget_ns
+				std::size_t iterations{ 1 };
+				for (double elapsed{ time_ns(c, iterations) }; elapsed < sampleTarget_ns && iterations < (std::size_t{ 1 } << 40); elapsed = time_ns(c, iterations)) {
+					if (elapsed <= 0.0)
+						iterations *= 10;
+					else iterations = std::max(iterations + 1, $c(std::size_t, $c(double, iterations) * std::min(10.0, (sampleTarget_ns * 1.2) / elapsed)));
+				}
+
+				std::vector<double> perOp;
+				perOp.reserve(samples);
+				for (std::size_t i{ 0 }; i < samples; ++i)
+					perOp.emplace_back(time_ns(c, iterations) / $c(double, iterations));
+				std::sort(perOp.begin(), perOp.end());
+
+				results.emplace_back(Result{ c.name, iterations, perOp.at(perOp.size() / 2), perOp.front() });
+			}
+			return results;
+		}
+	};
+
+	inline std::ostream& operator<<(std::ostream& os, std::vector<Result> const& results)
+	{
+		std::size_t nameWidth{ 4 };
+		for (const auto& r : results)
+			nameWidth = std::max(nameWidth, r.name.size());
+
+		const auto fmt{ [](double const ns) {
+			std::stringstream ss;
+			ss << std::fixed << std::setprecision(1) << ns;
+			return ss.str();
+		} };
+		const auto pad{ [&os](std::string const& s, std::size_t const width) -> std::ostream& {
+			os << s;
+			for (auto i{ s.size() }; i < width; ++i)
+				os << ' ';
+			return os;
+		} };
+
+		pad("Case", nameWidth + 2);
+		pad("ns/op (median)", 18);
+		pad("ns/op (min)", 15);
+		os << "Iterations" << '\n';
+		for (const auto& r : results) {
+			pad(r.name, nameWidth + 2);
+			pad(fmt(r.median_ns), 18);
+			pad(fmt(r.min_ns), 15);
+			os << r.iterations << '\n';
+		}
+		return os;
+	}
+}
@@ -0,0 +1,324 @@
+#include "Benchmark.hpp"
+
+#include <ObjectFormatter.hpp>
+
+#include <alchlib2.hpp>
+#include <opt3.hpp>
+
+#include <iostream>
+
+struct help {
+	friend std::ostream& operator<<(std::ostream& os, const help&)
+	{
+		return os
+			<< "alch2-bench" << '\n'
+			<< "  Microbenchmarks for the primitive operations used by alchlib2." << '\n'
+			<< '\n'
+			<< "USAGE:\n"
+			<< "  alch2-bench [OPTIONS]" << '\n'
+			<< '\n'
+			<< "OPTIONS:\n"
+			<< "  -h, --help            Shows this help display, then exits." << '\n'
+			<< "  -i, --ingr <PATH>     Override the ingredients registry used to generate benchmark inputs." << '\n'
+			<< "  -f, --filter <NAME>   Only run benchmark cases whose name contains <NAME>." << '\n'
+			<< "  -t, --time <MS>       Minimum time to spend measuring each case, in milliseconds. (Default: 250)" << '\n'
+			;
+	}
+};
+
+/// @brief	Benchmark inputs generated from the ingredients registry.
+struct Inputs {
+	std::vector<alchlib2::Keyword> keywords;
+	std::vector<alchlib2::Effect> effects;
+	std::vector<std::string> effectNames;
+	std::vector<alchlib2::Ingredient> ingredients;
+	alchlib2::Registry registry;
+	std::vector<std::vector<alchlib2::Ingredient>> pairs, triples, quads;
+	/// @brief	The registry indices of the ingredients in each of quads.
+	std::vector<std::vector<std::size_t>> quadIndices;
+	std::vector<alchlib2::Potion> potions;
+
+	/// @brief	The maximum number of combinations to generate for each of pairs/triples/quads.
+	static constexpr std::size_t MAX_COMBINATIONS{ 64 };
+
+	static bool shares_effect(alchlib2::Ingredient const& l, alchlib2::Ingredient const& r)
+	{
+		return std::any_of(l.effects.begin(), l.effects.end(), [&r](auto&& lfx) {
+			return std::any_of(r.effects.begin(), r.effects.end(), [&lfx](auto&& rfx) { return lfx.name == rfx.name; });
+		});
+	}
+
+	/// @brief	Appends a combination of `combination` + one more ingredient that shares an effect with any of them, if one exists.
+	bool extend(std::vector<alchlib2::Ingredient> const& combination, std::vector<std::vector<alchlib2::Ingredient>>& out, std::size_t const offset) const
+	{
+		for (std::size_t i{ 0 }; i < ingredients.size(); ++i) {
+			const auto& candidate{ ingredients[(i + offset) % ingredients.size()] };
+			if (std::any_of(combination.begin(), combination.end(), [&candidate](auto&& ingr) { return ingr.name == candidate.name; }))
+				continue;
+			if (std::any_of(combination.begin(), combination.end(), [&candidate](auto&& ingr) { return shares_effect(ingr, candidate); })) {
+				auto copy{ combination };
+				copy.emplace_back(candidate);
+				out.emplace_back(std::move(copy));
+				return true;
+			}
+		}
+		return false;
+	}
+
+	Inputs(alchlib2::Registry const& registry) : ingredients{ registry.Ingredients }, registry{ registry }
+	{
+		if (ingredients.size() < 4)
+			throw make_exception("The ingredients registry must contain at least 4 ingredients to generate benchmark inputs!");
+
+		for (const auto& ingr : ingredients) {
+			for (const auto& fx : ingr.effects) {
+				effects.emplace_back(fx);
+				if (std::find(effectNames.begin(), effectNames.end(), fx.name) == effectNames.end())
+					effectNames.emplace_back(fx.name);
+				for (const auto& kywd : fx.keywords)
+					if (std::find_if(keywords.begin(), keywords.end(), [&kywd](auto&& k) { return k.name == kywd.name && k.formID == kywd.formID; }) == keywords.end())
+						keywords.emplace_back(kywd);
+			}
+		}
+
+		// spread the generated combinations across the whole registry
+		const auto stride{ std::max<std::size_t>(1, ingredients.size() / MAX_COMBINATIONS) };
+		for (std::size_t i{ 0 }; i < ingredients.size() && pairs.size() < MAX_COMBINATIONS; i += stride) {
+			for (std::size_t j{ 1 }; j < ingredients.size(); ++j) {
+				const auto& l{ ingredients[i] }, & r{ ingredients[(i + j) % ingredients.size()] };
+				if (l.name != r.name && shares_effect(l, r)) {
+					pairs.emplace_back(std::vector<alchlib2::Ingredient>{ l, r });
+					break;
+				}
+			}
+		}
+		for (std::size_t i{ 0 }; i < pairs.size(); ++i)
+			extend(pairs[i], triples, i * stride);
+		for (std::size_t i{ 0 }; i < triples.size(); ++i)
+			extend(triples[i], quads, i * stride);
+
+		if (keywords.size() < 2 || pairs.empty() || triples.empty() || quads.empty())
+			throw make_exception("The ingredients registry doesn't contain enough overlapping effects to generate benchmark inputs!");
+
+		for (const auto& quad : quads) {
+			auto& indices{ quadIndices.emplace_back() };
+			for (const auto& ingr : quad)
+				indices.emplace_back($c(std::size_t, std::distance(ingredients.begin(), std::find_if(ingredients.begin(), ingredients.end(), [&ingr](auto&& i) { return i.name == ingr.name; }))));
+		}
+
+		const alchlib2::AlchemyCoreGameSettings coreGameSettings{};
+		const alchlib2::PotionBuilder builder{ coreGameSettings };
+		for (const auto& combination : pairs)
+			potions.emplace_back(builder.Build(combination, std::vector<alchlib2::Perk>{}));
+	}
+};
+
+template<typename T>
+static CONSTEXPR T const& cycle(std::vector<T> const& vec, std::size_t const i)
+{
+	return vec[i % vec.size()];
+}
+
+static void add_cases(bench::Runner& runner, Inputs const& in, alchlib2::AlchemyCoreGameSettings const& coreGameSettings)
+{
+	using namespace alchlib2;
+
+	// Keyword
+	runner.add("Keyword::operator==(Keyword)", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(cycle(in.keywords, i) == cycle(in.keywords, i + (i & 1)));
+	});
+	runner.add("Keyword::operator==(string)", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(cycle(in.keywords, i) == cycle(in.keywords, i + (i & 1)).name);
+	});
+	runner.add("Keyword::IsSimilarTo(Keyword)", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(cycle(in.keywords, i).IsSimilarTo(cycle(in.keywords, i + (i & 1))));
+	});
+	runner.add("Keyword::IsSimilarTo(string)", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(cycle(in.keywords, i).IsSimilarTo(cycle(in.keywords, i + (i & 1)).name, false));
+	});
+
+	// Effect
+	runner.add("Effect::GetDisposition", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(cycle(in.effects, i).GetDisposition());
+	});
+
+	// Ingredient
+	runner.add("Ingredient::AnyEffectIsSimilarTo(exact)", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(cycle(in.ingredients, i).AnyEffectIsSimilarTo(cycle(in.effectNames, i), true));
+	});
+	runner.add("Ingredient::AnyEffectIsSimilarTo(partial)", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(cycle(in.ingredients, i).AnyEffectIsSimilarTo(cycle(in.effectNames, i), false));
+	});
+
+	// Registry
+	runner.add("Registry::copy_inclusive_filter", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(in.registry.copy_inclusive_filter(cycle(in.effectNames, i).substr(0, 5), false, true, true, true));
+	});
+	runner.add("Registry::stream_inclusive_filter (first result)", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i) {
+			const auto stream{ in.registry.stream_inclusive_filter(cycle(in.effectNames, i).substr(0, 5), false, true, true, true) };
+			bench::do_not_optimize(stream.begin().index());
+		}
+	});
+
+	// get_common_effects
+	runner.add("get_common_effects(2)", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(get_common_effects(cycle(in.pairs, i)));
+	});
+	runner.add("get_common_effects(3)", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(get_common_effects(cycle(in.triples, i)));
+	});
+	runner.add("get_common_effects(4)", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(get_common_effects(cycle(in.quads, i)));
+	});
+
+	// EffectTable
+	runner.add("EffectTable::GetCommonEffects(4)", [&in](std::size_t n) {
+		const auto& table{ in.registry.GetEffectTable() };
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(table.GetCommonEffects(in.registry.Ingredients, cycle(in.quadIndices, i)));
+	});
+	runner.add("strongest ingredient by effect name", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i) {
+			const auto& name{ cycle(in.effectNames, i) };
+			const Effect* strongest{ nullptr };
+			for (const auto& ingr : in.registry.Ingredients)
+				for (const auto& fx : ingr.effects)
+					if (fx.name == name && (strongest == nullptr || fx.magnitude > strongest->magnitude))
+						strongest = &fx;
+			bench::do_not_optimize(strongest);
+		}
+	});
+	runner.add("EffectTable::FindStrongest", [&in](std::size_t n) {
+		const auto& table{ in.registry.GetEffectTable() };
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(table.FindStrongest($c(EffectTable::EffectID, i % table.effect_count())));
+	});
+
+	// PairMatrix
+	runner.add("get_common_effects(2) compatibility", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(!get_common_effects({ cycle(in.ingredients, i), cycle(in.ingredients, i * 7 + 1) }).empty());
+	});
+	runner.add("PairMatrix::Combines", [&in](std::size_t n) {
+		const auto& matrix{ in.registry.GetPairMatrix() };
+		const auto count{ matrix.ingredient_count() };
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(matrix.Combines(i % count, (i * 7 + 1) % count));
+	});
+	runner.add("PairMatrix construction", [&in](std::size_t n) {
+		const auto& table{ in.registry.GetEffectTable() };
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(PairMatrix{ table });
+	});
+
+	// PotionBuilder
+	runner.add("PotionBuilder::Build(4)", [&in, &coreGameSettings](std::size_t n) {
+		const PotionBuilder builder{ coreGameSettings };
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(builder.Build(cycle(in.quads, i), std::vector<Perk>{}));
+	});
+	runner.add("PotionBuilder::Build(Registry, 4)", [&in, &coreGameSettings](std::size_t n) {
+		const PotionBuilder builder{ coreGameSettings };
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(builder.Build(in.registry, cycle(in.quadIndices, i), std::vector<Perk>{}));
+	});
+
+	// AlchemyCoreFormula
+	runner.add("AlchemyCoreFormula::GetResult", [&in, &coreGameSettings](std::size_t n) {
+		const AlchemyCoreFormula formula{ coreGameSettings };
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(formula.GetResult(cycle(in.effects, i).magnitude));
+	});
+
+	// VanillaPerks; each iteration copies the potion, so the copy is measured separately as a baseline.
+	runner.add("Potion copy (perk baseline)", [&in](std::size_t n) {
+		for (std::size_t i{ 0 }; i < n; ++i) {
+			auto potion{ cycle(in.potions, i) };
+			bench::do_not_optimize(potion);
+		}
+	});
+	const auto add_perk_case{ [&runner, &in]<std::derived_from<PerkBase> TPerk>(TPerk const& perk) {
+		runner.add(std::string{ TPerk::Name } + "Perk::ApplyToPotion", [&in, perk](std::size_t n) {
+			for (std::size_t i{ 0 }; i < n; ++i) {
+				auto potion{ cycle(in.potions, i) };
+				perk.ApplyToPotion(potion);
+				bench::do_not_optimize(potion);
+			}
+		});
+	} };
+	add_perk_case(perks::AlchemistPerk{ 5 });
+	add_perk_case(perks::PhysicianPerk{});
+	add_perk_case(perks::BenefactorPerk{});
+	add_perk_case(perks::PoisonerPerk{});
+	add_perk_case(perks::PurityPerk{});
+
+	// ObjectFormatter
+	runner.add("ObjectFormatter::to_string(Ingredient)", [&in](std::size_t n) {
+		const ObjectFormatter fmt{ color::setcolor::yellow };
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(fmt.to_string(cycle(in.ingredients, i), cycle(in.ingredients, i).name.substr(0, 3), false));
+	});
+	runner.add("ObjectFormatter::to_string(Effect)", [&in](std::size_t n) {
+		const ObjectFormatter fmt{ color::setcolor::yellow };
+		for (std::size_t i{ 0 }; i < n; ++i)
+			bench::do_not_optimize(fmt.to_string(cycle(in.effects, i), cycle(in.effectNames, i), false));
+	});
+}
+
+int main(const int argc, char** argv)
+{
+	color::sync csync;
+	try {
+		opt3::ArgManager args{ argc, argv,
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'i', "ingr"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'f', "filter"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 't', "time"),
+		};
+
+		if (args.check_any<opt3::Flag, opt3::Option>('h', "help")) {
+			std::cout << help{} << std::endl;
+			return 0;
+		}
+
+		const std::filesystem::path registryPath{ args.castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('i', "ingr").value_or(std::filesystem::path{ ALCH2_BENCH_DEFAULT_REGISTRY }) };
+		if (!file::exists(registryPath))
+			throw make_exception("Couldn't find a valid ingredients registry at ", registryPath, "!");
+
+		const Inputs inputs{ alchlib2::Registry::ReadFrom(registryPath) };
+		const alchlib2::AlchemyCoreGameSettings coreGameSettings{};
+
+		bench::Runner runner;
+		if (const auto time{ args.getv_any<opt3::Flag, opt3::Option>('t', "time") }; time.has_value())
+			runner.minTime = std::chrono::milliseconds{ std::stoll(time.value()) };
+
+		add_cases(runner, inputs, coreGameSettings);
+
+		std::cout
+			<< "Registry:      " << registryPath.generic_string() << '\n'
+			<< "Ingredients:   " << inputs.ingredients.size() << '\n'
+			<< "Keywords:      " << inputs.keywords.size() << '\n'
+			<< "Combinations:  " << inputs.pairs.size() << " pairs, " << inputs.triples.size() << " triples, " << inputs.quads.size() << " quads" << '\n'
+			<< '\n'
+			<< runner.run(args.getv_any<opt3::Flag, opt3::Option>('f', "filter").value_or("")) << std::flush;
+
+		return 0;
+	} catch (const std::exception& ex) {
+		std::cerr << csync.get_fatal() << ex.what() << std::endl;
+		return 1;
+	} catch (...) {
+		std::cerr << csync.get_fatal() << "An undefined exception occurred!" << std::endl;
+		return 1;
+	}
+}
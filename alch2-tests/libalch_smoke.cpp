@@ -0,0 +1,111 @@
+/**
+ * @file	libalch_smoke.cpp
+ * @author	radj307
+ * @brief	Calls libalch's C API the way a consumer would, and checks that alch_build makes the same potion as alchlib2's PotionBuilder,
+ *			both with and without a settings handle, and when one of the names is misspelled.
+ */
+#include <libalch.h>
+
+#include <alchlib2.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// @brief	Prints the failed check & the library's last error, then returns false.
+static bool fail(std::string const& what)
+{
+	std::cerr << "Failed: " << what << " (" << alch_last_error() << ")\n";
+	return false;
+}
+
+/// @brief	Checks that a potion from alch_build has the same effects as the expected potion.
+static bool check_potion(alch_potion const* potion, alchlib2::Potion const& expected)
+{
+	if (alch_potion_effect_count(potion) != expected.effects.size())
+		return fail("alch_build returned " + std::to_string(alch_potion_effect_count(potion)) + " effects instead of " + std::to_string(expected.effects.size()));
+	for (std::size_t i{ 0 }; i < expected.effects.size(); ++i) {
+		alch_effect_info info{};
+		char name[256];
+		if (alch_potion_effect(potion, i, &info, name, sizeof(name), nullptr) != ALCH_OK)
+			return fail("alch_potion_effect");
+		const auto& effect{ expected.effects[i] };
+		if (effect.name != name || effect.magnitude != info.magnitude || effect.duration != info.duration)
+			return fail("Effect " + std::to_string(i) + " of the potion doesn't match PotionBuilder's");
+	}
+	if ((alch_potion_is_poison(potion) != 0) != expected.IsPoison())
+		return fail("alch_potion_is_poison");
+	return true;
+}
+
+int main(const int argc, char** argv)
+{
+	if (argc != 2) {
+		std::cerr << "Usage: " << argv[0] << " <REGISTRY>\n";
+		return 1;
+	}
+	if (alch_api_version() != LIBALCH_API_VERSION) {
+		fail("alch_api_version");
+		return 1;
+	}
+
+	alch_registry* registry{ nullptr };
+	if (alch_registry_open(argv[1], &registry) != ALCH_OK) {
+		fail("alch_registry_open");
+		return 1;
+	}
+	alch_settings* settings{ nullptr };
+	if (alch_settings_open(nullptr, nullptr, &settings) != ALCH_OK) {
+		fail("alch_settings_open");
+		alch_registry_close(registry);
+		return 1;
+	}
+
+	// find a pair of ingredients that makes a potion
+	const auto expectedRegistry{ alchlib2::Registry::ReadFrom(argv[1]) };
+	const alchlib2::AlchemyCoreGameSettings gameSettings{};
+	const alchlib2::PotionBuilder builder{ gameSettings };
+	const auto perks{ alchlib2::perks::VanillaPerks{}.GetAllPerks() };
+	std::vector<std::string> names;
+	alchlib2::Potion expected;
+	for (std::size_t i{ 1 }; i < expectedRegistry.size() && names.empty(); ++i) {
+		const std::vector<alchlib2::Ingredient> pair{ expectedRegistry.Ingredients[0], expectedRegistry.Ingredients[i] };
+		if (auto potion{ builder.Build(pair, perks) }; !potion.effects.empty()) {
+			names = { pair[0].name, pair[1].name };
+			expected = std::move(potion);
+		}
+	}
+
+	bool ok{ !names.empty() || fail("The registry doesn't contain a pair of ingredients that makes a potion") };
+	const char* const cnames[]{ names.empty() ? "" : names[0].c_str(), names.empty() ? "" : names[1].c_str() };
+
+	for (const auto* const buildSettings : { (alch_settings const*)nullptr, (alch_settings const*)settings }) {
+		if (!ok)
+			break;
+		alch_potion* potion{ nullptr };
+		if (alch_build(registry, buildSettings, cnames, 2, &potion) != ALCH_OK)
+			ok = fail(buildSettings == nullptr ? "alch_build without settings" : "alch_build with settings");
+		else ok = check_potion(potion, expected);
+		alch_potion_free(potion);
+	}
+
+	// a misspelled name is corrected to the same ingredient when no other ingredient name is as close to it
+	if (ok) {
+		auto misspelled{ names[0] };
+		misspelled.erase(misspelled.size() / 2, 1);
+		if (expectedRegistry.find_best_fit(misspelled, true, false) == expectedRegistry.end() && expectedRegistry.find_correction(misspelled) == expectedRegistry.begin()) {
+			const char* const misspelledNames[]{ misspelled.c_str(), cnames[1] };
+			alch_potion* potion{ nullptr };
+			if (alch_build(registry, nullptr, misspelledNames, 2, &potion) != ALCH_OK)
+				ok = fail("alch_build with the misspelled name \"" + misspelled + '"');
+			else ok = check_potion(potion, expected);
+			alch_potion_free(potion);
+		}
+	}
+
+	alch_settings_close(settings);
+	alch_registry_close(registry);
+	if (ok)
+		std::cout << "alch_build made the same potion as PotionBuilder from \"" << names[0] << "\" & \"" << names[1] << "\".\n";
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file	snapshot_concurrency.cpp
+ * @author	radj307
+ * @brief	Queries one RegistrySnapshot from many threads at once, starting before any of its lookup structures have been built, and
+ *			checks that every thread gets the same results as a single-threaded run. Build with ALCH2_TESTS_TSAN to check for data races.
+ */
+#include <alchlib2.hpp>
+
+#include <cstdint>
+#include <iostream>
+#include <latch>
+#include <thread>
+#include <vector>
+
+/// @brief	Mixes a value into a hash.
+static constexpr std::uint64_t mix(std::uint64_t const hash, std::uint64_t const value) noexcept
+{
+	return (hash ^ (value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2))) * 0x100000001B3ull;
+}
+
+/**
+ * @brief			Runs every kind of snapshot query for one ingredient.
+ * @returns			A hash of the results, which only depends on the registry & the ingredient index.
+ */
+static std::uint64_t query(alchlib2::RegistrySnapshot const& snapshot, std::size_t const i)
+{
+	const auto& ingredient{ snapshot[i] };
+	std::uint64_t hash{ i };
+
+	hash = mix(hash, snapshot.copy_inclusive_filter(ingredient.name, false, true, true).size());
+	hash = mix(hash, $c(std::uint64_t, std::distance(snapshot.begin(), snapshot.find_best_fit(ingredient.name, true, false))));
+
+	// drop one character so that the name has to be corrected
+	auto misspelled{ ingredient.name };
+	misspelled.erase(misspelled.size() / 2, 1);
+	for (const auto& match : snapshot.find_similar(misspelled))
+		hash = mix(mix(hash, match.value), match.distance);
+
+	for (const auto& completion : snapshot.GetNameCompleter().complete(std::string_view{ ingredient.name }.substr(0, 3), 5))
+		hash = mix(mix(hash, std::hash<std::string_view>{}(completion.name)), completion.count);
+
+	for (const auto partner : snapshot.GetEffectIndex().FindPartners(snapshot.GetEffectTable(), snapshot.GetRegistry().Ingredients, i))
+		hash = mix(hash, partner);
+
+	const auto& pairMatrix{ snapshot.GetPairMatrix() };
+	for (std::size_t j{ 0 }; j < snapshot.size(); ++j)
+		if (j != i && pairMatrix.Combines(i, j))
+			hash = mix(hash, j);
+
+	hash = mix(hash, snapshot.GetNameBlob().search(ingredient.name, true, true, true, true)[i]);
+	return hash;
+}
+
+/// @brief	Queries every ingredient, starting at the given offset, and sums the hashes so that the order doesn't matter.
+static std::uint64_t query_all(alchlib2::RegistrySnapshot const& snapshot, std::size_t const offset)
+{
+	std::uint64_t sum{ 0 };
+	for (std::size_t i{ 0 }; i < snapshot.size(); ++i)
+		sum += query(snapshot, (i + offset) % snapshot.size());
+	return sum;
+}
+
+int main(const int argc, char** argv)
+{
+	try {
+		if (argc != 2)
+			throw make_exception("Usage: ", argv[0], " <REGISTRY>");
+
+		const auto registry{ alchlib2::Registry::ReadFrom(argv[1]) };
+		if (registry.empty())
+			throw make_exception("The ingredients registry is empty!");
+
+		// the indexes must not be built yet, so that the threads race to build them
+		const alchlib2::RegistrySnapshot snapshot{ registry };
+
+		const auto threadCount{ std::max(4u, std::thread::hardware_concurrency()) };
+		std::vector<std::uint64_t> results(threadCount);
+		{
+			std::latch start{ threadCount };
+			std::vector<std::jthread> threads;
+			threads.reserve(threadCount);
+			for (unsigned t{ 0 }; t < threadCount; ++t) {
+				threads.emplace_back([&, t] {
+					start.arrive_and_wait();
+					results[t] = query_all(snapshot, t * snapshot.size() / threadCount);
+				});
+			}
+		}
+
+		const auto expected{ query_all(alchlib2::RegistrySnapshot{ snapshot.Thaw() }, 0) };
+
+		int failures{ 0 };
+		for (unsigned t{ 0 }; t < threadCount; ++t) {
+			if (results[t] != expected) {
+				std::cerr << "Thread " << t << " got different results than a single-threaded run!\n";
+				++failures;
+			}
+		}
+		if (failures == 0)
+			std::cout << threadCount << " threads queried " << snapshot.size() << " ingredients with identical results.\n";
+		return failures == 0 ? 0 : 1;
+	} catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		return 1;
+	}
+}
@@ -17,16 +17,19 @@
 //	KeywordName,
 //};
 
-static color::sync csync;
-static color::palette<alchlib2::EKeywordDisposition> keywordColors{
-	std::make_pair(alchlib2::EKeywordDisposition::Unknown, color::light_gray),
-	std::make_pair(alchlib2::EKeywordDisposition::Neutral, color::white),
-	std::make_pair(alchlib2::EKeywordDisposition::Positive, color::green),
-	std::make_pair(alchlib2::EKeywordDisposition::Cure, color::light_green),
-	std::make_pair(alchlib2::EKeywordDisposition::FortifyStat, color::cyan),
-	std::make_pair(alchlib2::EKeywordDisposition::Negative, color::red),
-	std::make_pair(alchlib2::EKeywordDisposition::InfluenceOther, color::purple),
-};
+/// @brief	Gets the colors used for each keyword disposition.
+inline color::palette<alchlib2::EKeywordDisposition> make_keyword_colors()
+{
+	return{
+		std::make_pair(alchlib2::EKeywordDisposition::Unknown, color::light_gray),
+		std::make_pair(alchlib2::EKeywordDisposition::Neutral, color::white),
+		std::make_pair(alchlib2::EKeywordDisposition::Positive, color::green),
+		std::make_pair(alchlib2::EKeywordDisposition::Cure, color::light_green),
+		std::make_pair(alchlib2::EKeywordDisposition::FortifyStat, color::cyan),
+		std::make_pair(alchlib2::EKeywordDisposition::Negative, color::red),
+		std::make_pair(alchlib2::EKeywordDisposition::InfluenceOther, color::purple),
+	};
+}
 
 inline constexpr const auto EFFECT_INDENT{ 4 };
 inline constexpr const auto INGREDIENT_INDENT{ 2 };
@@ -35,17 +38,28 @@ inline constexpr const auto KEYWORD_INDENT{ 6 };
 inline constexpr const auto EFFECT_MAGNITUDE_INDENT{ 40 };
 inline constexpr const auto EFFECT_DURATION_INDENT{ 6 };
 
+/**
+ * @brief	Formats ingredients & effects for console output.
+ *			All of the formatting state, including the color settings, is owned by each instance rather than shared globally,
+ *			so separate instances can be used from separate threads at the same time.
+ */
 struct ObjectFormatter {
 	color::setcolor searchTermHighlightColor;
 	bool quiet;
 	bool all;
+	color::sync csync;
+	color::palette<alchlib2::EKeywordDisposition> keywordColors{ make_keyword_colors() };
 
-	STRCONSTEXPR ObjectFormatter(const color::setcolor& searchTermHighlightColor, const bool quiet = false, const bool all = false) : searchTermHighlightColor{ searchTermHighlightColor }, quiet{ quiet }, all{ all } {}
+	ObjectFormatter(const color::setcolor& searchTermHighlightColor, const bool quiet = false, const bool all = false, const bool colorEnabled = true) : searchTermHighlightColor{ searchTermHighlightColor }, quiet{ quiet }, all{ all }
+	{
+		csync.setEnabled(colorEnabled);
+		keywordColors.setEnabled(colorEnabled);
+	}
 
 #	pragma region split_for_highlighter
-	std::tuple<std::string, std::string, std::string> split_for_highlighter(const std::string& input, const std::string& substr) const
+	std::tuple<std::string, std::string, std::string> split_for_highlighter(const std::string& input, std::string_view const substr) const
 	{
-		const auto& startingPos{ str::tolower(input).find(str::tolower(substr)) };
+		const auto& startingPos{ alchlib2::ci::find(input, substr) };
 		if (startingPos == std::string::npos) return{ input, {}, {} };
 		const auto& substrLen{ substr.length() };
 		return{ input.substr(0ull, startingPos), input.substr(startingPos, substrLen), input.substr(startingPos + substrLen) };
@@ -60,13 +74,12 @@ struct ObjectFormatter {
 		return{ input, {}, {} };
 	}
 #	pragma endregion split_for_highlighter
-	bool do_highlight(std::string input, const std::string& search_term, const bool onlyHighlightExactMatch = false) const
+	bool do_highlight(std::string_view const input, std::string_view const search_term, const bool onlyHighlightExactMatch = false) const
 	{
-		return onlyHighlightExactMatch ? str::tolower(search_term) == str::tolower(input) : str::tolower(input).find(str::tolower(search_term)) != std::string::npos;
+		return alchlib2::ci::matches(input, search_term, onlyHighlightExactMatch);
 	}
-	bool do_highlight(std::string input, const std::vector<std::string>& search_terms, const bool onlyHighlightExactMatch = false) const
+	bool do_highlight(std::string_view const input, const std::vector<std::string>& search_terms, const bool onlyHighlightExactMatch = false) const
 	{
-		input = str::tolower(input);
 		return std::any_of(search_terms.begin(), search_terms.end(), [&](auto&& search_term) { return do_highlight(input, search_term, onlyHighlightExactMatch); });
 	}
 
@@ -126,7 +139,7 @@ struct ObjectFormatter {
 
 #	pragma region print
 	template<var::any_same_or_convertible<std::string, std::vector<std::string>> TSearchTerm = std::string>
-	std::ostream& print(std::ostream& os, const alchlib2::Effect& effect, const TSearchTerm& search_term = {}, const bool& onlyHighlightExactMatch = false)
+	std::ostream& print(std::ostream& os, const alchlib2::Effect& effect, const TSearchTerm& search_term = {}, const bool& onlyHighlightExactMatch = false) const
 	{
 		os << shared::indent(EFFECT_INDENT) << to_string(effect, search_term, onlyHighlightExactMatch);
 		if (all) {
@@ -137,7 +150,7 @@ struct ObjectFormatter {
 		return os;
 	}
 	template<var::any_same_or_convertible<std::string, std::vector<std::string>> TSearchTerm = std::string>
-	std::ostream& print(std::ostream& os, const alchlib2::Ingredient& ingredient, TSearchTerm const& search_term = {}, const bool onlyHighlightExactMatch = false)
+	std::ostream& print(std::ostream& os, const alchlib2::Ingredient& ingredient, TSearchTerm const& search_term = {}, const bool onlyHighlightExactMatch = false) const
 	{
 		os << shared::indent(INGREDIENT_INDENT) << to_string(ingredient, search_term, onlyHighlightExactMatch);
 		if (quiet) {
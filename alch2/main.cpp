@@ -7,7 +7,14 @@
 #include <opt3.hpp>
 #include <envpath.hpp>
 
+#include <cctype>
+#include <cmath>
+#include <chrono>
+#include <future>
 #include <iostream>
+#include <sstream>
+#include <string_view>
+#include <tuple>
 
 struct help {
 	std::string programName;
@@ -21,8 +28,11 @@ struct help {
 			<< "USAGE:\n"
 			<< "  " << h.programName << " <OPTIONS>" << '\n'
 			<< "  " << h.programName << " <MODE> <INPUT>..." << '\n'
+			<< "  " << h.programName << " <MODE> <INPUT>... -- <MODE> <INPUT>..." << '\n'
 			<< '\n'
 			<< "  Arguments that include whitespace must be enclosed with quotes (\"), or they'll be split into multiple inputs." << '\n'
+			<< "  Several modes can be run in order by separating them with \"--\". The registry & configs are only loaded once, and" << '\n'
+			<< "  options apply to every mode no matter where they're given. The output of each mode is separated by an empty line." << '\n'
 			<< '\n'
 			<< "OPTIONS:\n"
 			<< "  -h, --help          Shows this help display, then exits." << '\n'
@@ -32,7 +42,21 @@ struct help {
 			<< "  -a, --all           Shows all detailed console output." << '\n'
 			<< "  -e, --exact         Match whole search terms rather than allowing any result that contains the search term." << '\n'
 			<< "  -i, --ingr <PATH>   Override the default search path for the ingredients registry." << '\n'
-			<< "  -g, --gmst <PATH>   Override the default search path for the game settings config. This only applies to build mode." << '\n'
+			<< "  -g, --gmst <PATH>   Override the default search path for the game settings config. This only applies to build, pairs & recipe modes." << '\n'
+			<< "  -P, --perks <PATH>  Override the default search path for the perks config. This only applies to build, pairs & recipe modes." << '\n'
+			<< "  -F, --formula <PATH>" << '\n'
+			<< "                      Replaces the vanilla alchemy formula with the one in the formula config at <PATH>. See FORMULA CONFIGS below." << '\n'
+			<< "  -m, --profiles <FILE>" << '\n'
+			<< "                      Loads the character profiles that table mode builds recipes for. See PROFILE FILES below." << '\n'
+			<< "                      When this isn't specified, table mode uses a single profile made from the --gmst & --perks configs." << '\n'
+			<< "  -M, --min-magnitude <MAGNITUDE>" << '\n'
+			<< "                      Only lists recipes in produces mode whose effect has at least <MAGNITUDE> under the current settings." << '\n'
+			<< "  -t, --time-limit <SECONDS>" << '\n'
+			<< "                      Stops recipe mode after <SECONDS> and shows the best recipe found so far. Decimals are allowed." << '\n'
+			<< "  -L, --limit <COUNT> Shows at most <COUNT> names for each prefix in complete mode. Defaults to 10; 0 shows every name." << '\n'
+			<< "  -d, --recipe-db <PATH>" << '\n'
+			<< "                      Answers produces mode from the recipe database at <PATH> instead of building potions. The database must" << '\n'
+			<< "                      have been built by --build-recipe-db from the current registry, game settings, perks & formula." << '\n'
 			//< continue [OPTIONS] here
 			<< '\n'
 			<< "MODES:\n"
@@ -40,7 +64,40 @@ struct help {
 			<< "  -s, --search        Search for ingredients or effects. Requires at least one <INPUT>." << '\n'
 			<< "  -S, --smart         Search for ingredients that have effects matching all of the given <INPUTS>." << '\n'
 			<< "  -B, --build         " << '\n'
+			<< "  -p, --pairs         Shows every ingredient that can be combined with each <INPUT> ingredient, and the potion each pair produces." << '\n'
+			<< "  -c, --convert       Writes the registry to the <INPUT> path using the normalized (version 2) registry schema." << '\n'
+			<< "  -b, --best          Shows the ingredient that best fits each <INPUT>, which is the ingredient that build mode would use." << '\n'
+			<< "                      An <INPUT> that doesn't match any ingredient is corrected to the closest ingredient name, as in build mode." << '\n'
+			<< "  -r, --recipe        Finds the combination of ingredients that produces the strongest potion with every <INPUT> effect." << '\n'
+			<< "                      The strength of each effect is its magnitude multiplied by its duration." << '\n'
+			<< "  -E, --produces      Lists every combination of 2 or 3 ingredients that produces each <INPUT> effect, strongest first." << '\n'
+			<< "  -C, --complete      Lists the ingredient, effect & keyword names with a word that begins with each <INPUT>, one per line." << '\n'
+			<< "                      Names that begin with <INPUT> are shown first, then names that more ingredients have." << '\n'
+			<< "  -Q, --queries <FILE>" << '\n'
+			<< "                      Runs every query in <FILE> concurrently against the same registry, and shows the results in order." << '\n'
+			<< "  -T, --table <FILE>  Builds every recipe in <FILE> for every character profile, and shows a table of the potions' strongest effects." << '\n'
+			<< "                      Each line of <FILE> is one recipe, in the form \"<INGREDIENT> <INGREDIENT>...\"." << '\n'
+			<< "  -D, --build-recipe-db <PATH>" << '\n'
+			<< "                      Builds the potion of every valid combination of 2 or 3 ingredients, and writes them to a recipe database at" << '\n'
+			<< "                      <PATH> for use with --recipe-db. The database must be rebuilt when the registry or any config changes." << '\n'
 			//< continue [MODES] here
+			<< '\n'
+			<< "QUERY FILES:\n"
+			<< "  Each line of a query file is one query, in the form \"<MODE> <INPUT>...\", where <MODE> is one of:" << '\n'
+			<< "    list, search, smart, build, pairs, best, recipe, produces, complete" << '\n'
+			<< "  Empty lines & lines beginning with '#' are ignored. Inputs that include whitespace must be enclosed with quotes (\")." << '\n'
+			<< '\n'
+			<< "PROFILE FILES:\n"
+			<< "  Each line of a profile file is one profile, in the form \"<NAME> [<GMST PATH>] [<PERKS PATH>]\"." << '\n'
+			<< "  Relative paths are relative to the profile file. Omitted paths, or paths given as '-', use the default config." << '\n'
+			<< "  Empty lines & lines beginning with '#' are ignored." << '\n'
+			<< '\n'
+			<< "FORMULA CONFIGS:\n"
+			<< "  A formula config is a JSON object with an \"expression\" string, and an optional \"terms\" object of named numbers." << '\n'
+			<< "  Expressions support numbers, + - * /, parentheses, min(a, b), max(a, b) & pow(a, b). Identifiers may be \"base\" (the" << '\n'
+			<< "  effect's base magnitude), the fAlchemyIngredientInitMult, fAlchemySkillFactor, fAlchemyAV & fAlchemyMod game settings, or a term." << '\n'
+			<< "  The vanilla formula is:" << '\n'
+			<< "    " << alchlib2::DefaultFormulaExpression << '\n'
 			;
 	}
 };
@@ -52,16 +109,918 @@ enum Mode : std::uint8_t {
 	/// @brief	Searches for ingredients that have ALL of the specified names
 	SmartSearch,
 	Build,
+	/// @brief	Finds all ingredients that share an effect with the specified ingredient
+	Pairs,
+	/// @brief	Writes the registry using the current schema version
+	Convert,
+	/// @brief	Shows the ingredient that best fits each of the specified names
+	Best,
+	/// @brief	Finds the combination of ingredients that produces the strongest potion with all of the specified effects
+	Recipe,
+	/// @brief	Lists every combination of ingredients that produces each of the specified effects
+	Produces,
+	/// @brief	Lists the ingredient, effect & keyword names that begin with each of the specified prefixes
+	Complete,
+	/// @brief	Runs each query in a file
+	Queries,
+	/// @brief	Builds each recipe in a file for each character profile
+	Table,
+	/// @brief	Writes a recipe database of every valid combination of ingredients
+	BuildRecipeDatabase,
 };
 
-int main(const int argc, char** argv)
+/// @brief	Everything that the modes need besides the registry & their parameters.
+struct ModeContext {
+	ObjectFormatter const& fmt;
+	bool exact;
+	bool all;
+	alchlib2::AlchemyCoreGameSettings coreGameSettings;
+	std::vector<alchlib2::Perk> perks;
+	/// @brief	The maximum amount of time that recipe mode may search for.
+	std::optional<std::chrono::steady_clock::duration> timeLimit;
+	/// @brief	The minimum magnitude of the effect in produces mode.
+	float minMagnitude;
+	/// @brief	The maximum number of names that complete mode shows for each prefix, or 0 for no limit.
+	std::size_t completionLimit;
+	/// @brief	The formula config to use instead of the vanilla alchemy formula.
+	std::optional<alchlib2::FormulaConfig> formula;
+	/// @brief	The formula config compiled for coreGameSettings.
+	std::optional<alchlib2::FormulaProgram> formulaProgram;
+
+	/// @brief	Creates a potion builder that uses the game settings & formula.
+	alchlib2::PotionBuilder make_builder() const
+	{
+		if (formulaProgram.has_value())
+			return alchlib2::AlchemyCoreFormula{ coreGameSettings, alchlib2::FormulaProgram{ formulaProgram.value() } };
+		return { coreGameSettings };
+	}
+};
+
+/**
+ * @brief			Checks that the given parameters are valid for the given mode.
+ * @param warn		The stream to write warnings to.
+ * @throws			ex::except when the parameters aren't valid for the mode.
+ */
+inline void validate_params(const Mode mode, std::vector<std::string> const& params, std::ostream& warn)
 {
-	try {
-		opt3::ArgManager args{ argc, argv,
+	switch (mode) {
+	case Mode::List:
+	case Mode::BuildRecipeDatabase:
+		if (!params.empty()) { // if parameters WERE specified, show a warning message:
+			warn << "Ignoring arguments: ";
+			bool fst{ true };
+			for (const auto& param : params) {
+				if (fst) fst = false;
+				else warn << ", ";
+
+				warn << '"' << param << '"';
+			}
+		}
+		break;
+	case Mode::Search:
+		if (params.empty())
+			throw make_exception("Not enough search terms were specified for search mode. (Min 1)");
+		break;
+	case Mode::SmartSearch:
+		if (params.empty())
+			throw make_exception("Not enough effects were specified for smart search mode. (Min 1)");
+		break;
+	case Mode::Build:
+		if (params.size() < 2)
+			throw make_exception("Not enough ingredients were specified for build mode. (Min 2)");
+		break;
+	case Mode::Pairs:
+		if (params.empty())
+			throw make_exception("Not enough ingredients were specified for pairs mode. (Min 1)");
+		break;
+	case Mode::Convert:
+		if (params.size() != 1)
+			throw make_exception("Convert mode requires exactly one output path!");
+		break;
+	case Mode::Best:
+		if (params.empty())
+			throw make_exception("Not enough search terms were specified for best mode. (Min 1)");
+		break;
+	case Mode::Recipe:
+		if (params.empty())
+			throw make_exception("Not enough effects were specified for recipe mode. (Min 1)");
+		break;
+	case Mode::Produces:
+		if (params.empty())
+			throw make_exception("Not enough effects were specified for produces mode. (Min 1)");
+		break;
+	case Mode::Complete:
+		if (params.empty())
+			throw make_exception("Not enough prefixes were specified for complete mode. (Min 1)");
+		break;
+	default:
+		break;
+	}
+}
+
+/// @brief	Gets the error message for a name that doesn't match any ingredient, which suggests the most similar ingredient names.
+inline std::string get_not_found_message(alchlib2::Registry const& registry, std::string const& name)
+{
+	constexpr std::size_t MaxSuggestions{ 3 };
+	const auto similar{ registry.find_similar(name) };
+	const auto count{ std::min(similar.size(), MaxSuggestions) };
+
+	std::stringstream ss;
+	ss << "Couldn't find an ingredient matching \"" << name << "\"!";
+	for (std::size_t i{ 0 }; i < count; ++i) {
+		if (i == 0) ss << " Did you mean ";
+		else if (i + 1 == count) ss << " or ";
+		else ss << ", ";
+		ss << '"' << registry.Ingredients[similar[i].value].name << '"';
+	}
+	if (count != 0)
+		ss << '?';
+	return ss.str();
+}
+
+/**
+ * @brief			Finds the ingredient that best fits a name, like Registry::find_best_fit. A name that doesn't match any ingredient is
+ *					treated as a typo: when one ingredient name is closer to it than any other, that ingredient is used and a note is
+ *					written. Otherwise, an error that suggests the closest names is thrown.
+ * @param registry	The registry to find the ingredient in.
+ * @param name		The ingredient name to search for.
+ * @param notes		The stream to write a note to when the name is corrected.
+ * @param ctx		The formatter to use for notes.
+ * @throws			ex::except when the name doesn't match any ingredient and can't be corrected.
+ */
+inline alchlib2::Ingredient const& resolve_ingredient(alchlib2::Registry const& registry, std::string const& name, std::ostream& notes, ModeContext const& ctx)
+{
+	if (const auto it{ registry.find_best_fit(name, true, false) }; it != registry.end())
+		return *it;
+
+	const auto it{ registry.find_correction(name) };
+	if (it == registry.end())
+		throw make_exception(get_not_found_message(registry, name));
+
+	const auto& csync{ ctx.fmt.csync };
+	notes << csync(color::gray) << "Couldn't find an ingredient matching \"" << name << "\"; using \"" << it->name << "\" instead." << csync() << '\n';
+	return *it;
+}
+/**
+ * @brief			Finds the ingredient that best fits each name with resolve_ingredient, so that no name is ever skipped.
+ * @returns			A registry with one ingredient per name, in the same order as the names.
+ * @throws			ex::except when a name doesn't match any ingredient and can't be corrected.
+ */
+inline alchlib2::Registry resolve_ingredients(alchlib2::Registry const& registry, std::vector<std::string> const& names, std::ostream& notes, ModeContext const& ctx)
+{
+	alchlib2::Registry resolved;
+	resolved.Ingredients.reserve(names.size());
+	for (const auto& name : names)
+		resolved.Ingredients.emplace_back(resolve_ingredient(registry, name, notes, ctx));
+	return resolved;
+}
+
+/// @brief	Writes the line that begins the results of produces mode for one effect, followed by an opening brace.
+inline void print_produces_header(std::ostream& os, std::string const& name, ModeContext const& ctx)
+{
+	const auto& csync{ ctx.fmt.csync };
+	os << "Showing recipes that produce: \"" << csync(ctx.fmt.searchTermHighlightColor) << name << csync() << '\"';
+	if (ctx.minMagnitude > 0.0f)
+		os << " with a magnitude of at least " << ctx.minMagnitude;
+	os << '\n' << csync(color::red) << '{' << csync() << '\n';
+}
+/// @brief	Writes one recipe in the results of produces mode, followed by its potion's effects.
+inline void print_produced_recipe(std::ostream& os, std::vector<std::string_view> const& ingredientNames, std::string_view const potionName, std::vector<alchlib2::Effect> const& effects, ModeContext const& ctx)
+{
+	const auto& csync{ ctx.fmt.csync };
+	os << shared::indent(INGREDIENT_INDENT);
+	for (bool fst{ true }; const auto& name : ingredientNames) {
+		if (fst) fst = false;
+		else os << csync(color::gray) << " + " << csync();
+		os << name;
+	}
+	os << csync(color::gray) << " -> " << csync() << '"' << csync(color::bold) << potionName << csync(color::no_bold) << '"';
+	for (const auto& effect : effects) {
+		os << '\n';
+		ctx.fmt.print(os, effect);
+	}
+}
+
+/**
+ * @brief			Runs a single mode and writes its output to the given stream.
+ *					This only reads from its arguments, so it may be called from several threads at once.
+ * @param os		The output stream.
+ * @param mode		The mode to run. Must not be Mode::Queries.
+ * @param params	The mode's parameters, which must have already been checked with validate_params.
+ * @param registry	The registry to query. In build mode, this must contain only the ingredients to combine.
+ * @param ctx		The formatter, options & configs to use.
+ */
+inline void run_mode(std::ostream& os, const Mode mode, std::vector<std::string> const& params, alchlib2::Registry const& registry, ModeContext const& ctx)
+{
+	const auto& fmt{ ctx.fmt };
+	const auto& csync{ fmt.csync };
+	const auto& exact{ ctx.exact };
+	const auto& all{ ctx.all };
+
+	switch (mode) {
+	case Mode::List: {
+		os << "Listing all ingredients:"
+			<< '\n' << csync(color::red) << '{' << csync() << '\n';
+
+		bool fst{ true };
+		for (const auto& ingr : registry.Ingredients) {
+			if (fst) fst = false;
+			else os << '\n';
+			fmt.print(os, ingr);
+		}
+
+		os << "\n" << csync(color::red) << '}' << csync() << '\n';
+		break;
+	}
+	case Mode::Search: {
+		for (const auto& name : params) {
+			os << "Showing results for: \"" << csync(fmt.searchTermHighlightColor) << name << csync() << "\"\n"
+				<< csync(color::red) << '{' << csync() << '\n';
+
+			// results are printed as they're found
+			bool fst{ true };
+			for (const auto& ingr : registry.stream_inclusive_filter(name, exact, true, true)) {
+				if (fst) fst = false;
+				else os << '\n';
+				fmt.print(os, ingr, name, exact);
+			}
+
+			os << "\n" << csync(color::red) << '}' << csync() << '\n';
+		}
+		break;
+	}
+	case Mode::SmartSearch: {
+		os << "Showing results for: ";
+		bool fst{ true };
+		for (const auto& name : params) {
+			if (fst) fst = false;
+			else os << ", ";
+			os << '\"' << csync(fmt.searchTermHighlightColor) << name << csync() << '\"';
+		}
+		os << '\n' << csync(color::red) << '{' << csync() << '\n';
+
+		const auto results{ registry.stream_if([&params, &exact](alchlib2::Ingredient const& ingredient) {
+			return std::all_of(params.begin(), params.end(), [&ingredient, &exact](auto&& name) { return ingredient.AnyEffectIsSimilarTo(name, exact); });
+		}) };
+
+		fst = true;
+		for (const auto& ingr : results) {
+			if (fst) fst = false;
+			else os << '\n';
+			fmt.print(os, ingr, params, exact);
+		}
+
+		os << '\n' << csync(color::red) << '}' << csync() << '\n';
+		break;
+	}
+	case Mode::Build: {
+		const auto& coreGameSettings{ ctx.coreGameSettings };
+
+		// collect all the ingredients:
+		// in build mode, the registry only contains the best fit for each parameter
+		const auto& results{ registry };
+		const auto builder{ ctx.make_builder() };
+		const auto potion{ builder.Build(results.Ingredients, ctx.perks) };
+
+		// print input ingredients:
+		os << "Combining ingredients:" << '\n' << csync(color::red) << '{' << csync() << '\n';
+		bool fst{ true };
+		for (const auto& ingr : results.Ingredients) {
+			if (fst) fst = false;
+			else os << '\n';
+			fmt.print(os, ingr, params, exact);
+		}
+		os << '\n' << csync(color::red) << '}' << csync() << '\n';
+
+		// print potion name & alchemy stats
+		os << "Produces: \"" << csync(color::bold) << potion.name << csync(color::no_bold) << "\"\n";
+		if (all) {
+			os
+				<< csync(color::gray) << "With alchemy stats:" << '\n'
+				<< "  Skill:     " << csync(color::green) << coreGameSettings.fAlchemyAV.value << csync(color::gray) << '\n'
+				<< "  Modifier:  " << csync(color::green) << coreGameSettings.fAlchemyMod.value << csync() << '\n';
+		}
+
+		// print effects:
+		os << "Effects:" << '\n' << csync(color::red) << '{' << csync() << '\n';
+		fst = true;
+		for (const auto& effect : potion.effects) {
+			if (fst) fst = false;
+			else os << '\n';
+			fmt.print(os, effect);
+		}
+		os << '\n' << csync(color::red) << '}' << csync() << '\n';
+
+		break;
+	}
+	case Mode::Pairs: {
+		const auto builder{ ctx.make_builder() };
+		const auto& perks{ ctx.perks };
+
+		const auto& effectTable{ registry.GetEffectTable() };
+		const auto& effectIndex{ registry.GetEffectIndex() };
+
+		for (const auto& name : params) {
+			const auto ingr{ registry.find_best_fit(name, true, false) };
+			if (ingr == registry.end())
+				throw make_exception(get_not_found_message(registry, name));
+			const auto ingredientIndex{ $c(std::size_t, std::distance(registry.begin(), ingr)) };
+
+			os << "Showing ingredients that combine with: \"" << csync(fmt.searchTermHighlightColor) << ingr->name << csync() << "\"\n"
+				<< csync(color::red) << '{' << csync() << '\n';
+
+			bool fst{ true };
+			for (const auto& partnerIndex : effectIndex.FindPartners(effectTable, registry.Ingredients, ingredientIndex)) {
+				if (fst) fst = false;
+				else os << '\n';
+
+				const std::array<std::size_t, 2> pair{ ingredientIndex, partnerIndex };
+				const auto potion{ builder.Build(registry, pair, perks) };
+
+				// print the partner & the potion it produces, followed by the potion's effects:
+				os << shared::indent(INGREDIENT_INDENT) << fmt.to_string(registry.Ingredients[partnerIndex], std::string{})
+					<< csync(color::gray) << " -> " << csync() << '"' << csync(color::bold) << potion.name << csync(color::no_bold) << '"';
+				for (const auto& effect : potion.effects) {
+					os << '\n';
+					fmt.print(os, effect);
+				}
+			}
+
+			os << '\n' << csync(color::red) << '}' << csync() << '\n';
+		}
+		break;
+	}
+	case Mode::Best: {
+		for (const auto& name : params) {
+			// this is the ingredient that build mode would use
+			const auto& ingr{ resolve_ingredient(registry, name, os, ctx) };
+
+			os << "Best fit for: \"" << csync(fmt.searchTermHighlightColor) << name << csync() << "\"\n"
+				<< csync(color::red) << '{' << csync() << '\n';
+
+			fmt.print(os, ingr, name, exact);
+
+			os << '\n' << csync(color::red) << '}' << csync() << '\n';
+		}
+		break;
+	}
+	case Mode::Recipe: {
+		const auto builder{ ctx.make_builder() };
+		const alchlib2::RecipeSearch search{ registry, builder, ctx.perks };
+
+		alchlib2::RecipeSearch::Options options;
+		// only ingredients with at least one of the effects can contribute to the potion
+		const auto candidates{ registry.stream_if([&params, &exact](alchlib2::Ingredient const& ingredient) {
+			return std::any_of(params.begin(), params.end(), [&ingredient, &exact](auto&& name) { return ingredient.AnyEffectIsSimilarTo(name, exact); });
+		}) };
+		for (auto it{ candidates.begin() }; it != candidates.end(); ++it)
+			options.candidates.emplace_back(it.index());
+		if (ctx.timeLimit.has_value())
+			options.deadline = std::chrono::steady_clock::now() + ctx.timeLimit.value();
+		if (all) {
+			options.onImprovement = [&](alchlib2::RecipeSearch::Recipe const& recipe) {
+				os << csync(color::gray) << "Found \"" << recipe.potion.name << "\" with strength " << recipe.score << csync() << '\n';
+			};
+		}
+
+		// the score is the total strength of the requested effects, and potions missing any of them are rejected
+		const auto result{ search.Run([&params, &exact](alchlib2::Potion const& potion) -> std::optional<double> {
+			double score{ 0.0 };
+			for (const auto& name : params) {
+				const auto effect{ std::find_if(potion.effects.begin(), potion.effects.end(), [&name, &exact](auto&& effect) { return effect.IsSimilarTo(name, exact); }) };
+				if (effect == potion.effects.end())
+					return std::nullopt;
+				score += effect->duration == 0 ? effect->magnitude : effect->magnitude * effect->duration;
+			}
+			return score;
+		}, options) };
+
+		os << "Best recipe for: ";
+		bool fst{ true };
+		for (const auto& name : params) {
+			if (fst) fst = false;
+			else os << ", ";
+			os << '\"' << csync(fmt.searchTermHighlightColor) << name << csync() << '\"';
+		}
+		os << '\n' << csync(color::red) << '{' << csync() << '\n';
+		if (result.best.has_value()) {
+			fst = true;
+			for (const auto& index : result.best->ingredients) {
+				if (fst) fst = false;
+				else os << '\n';
+				fmt.print(os, registry.Ingredients[index], params, exact);
+			}
+		}
+		os << '\n' << csync(color::red) << '}' << csync() << '\n';
+
+		if (result.best.has_value()) {
+			os << "Produces: \"" << csync(color::bold) << result.best->potion.name << csync(color::no_bold) << "\"\n"
+				<< "Effects:" << '\n' << csync(color::red) << '{' << csync() << '\n';
+			fst = true;
+			for (const auto& effect : result.best->potion.effects) {
+				if (fst) fst = false;
+				else os << '\n';
+				fmt.print(os, effect);
+			}
+			os << '\n' << csync(color::red) << '}' << csync() << '\n';
+		}
+		else os << "No combination of ingredients produces all of the specified effects." << '\n';
+
+		if (!result.is_exhaustive()) {
+			os << csync(color::gray) << "Search was stopped by the "
+				<< (result.stopReason == alchlib2::RecipeSearch::EStopReason::Deadline ? "time limit" : "user")
+				<< " after " << result.evaluated << " combinations; a better recipe may exist." << csync() << '\n';
+		}
+		break;
+	}
+	case Mode::Produces: {
+		const auto builder{ ctx.make_builder() };
+		const alchlib2::RecipeSearch search{ registry, builder, ctx.perks };
+
+		for (const auto& name : params) {
+			const auto result{ search.FindProducing(name, exact, ctx.minMagnitude) };
+
+			print_produces_header(os, name, ctx);
+			bool fst{ true };
+			for (const auto& recipe : result.recipes) {
+				if (fst) fst = false;
+				else os << '\n';
+
+				std::vector<std::string_view> ingredientNames;
+				for (const auto& index : recipe.ingredients)
+					ingredientNames.emplace_back(registry.Ingredients[index].name);
+				print_produced_recipe(os, ingredientNames, recipe.potion.name, recipe.potion.effects, ctx);
+			}
+
+			os << '\n' << csync(color::red) << '}' << csync() << '\n';
+			if (all)
+				os << csync(color::gray) << "Found " << result.recipes.size() << " recipes after building " << result.evaluated << " candidate potions." << csync() << '\n';
+		}
+		break;
+	}
+	case Mode::Complete: {
+		// one name per line without any decoration, so that the output can be used for shell completion
+		const auto& completer{ registry.GetNameCompleter() };
+		for (const auto& prefix : params) {
+			for (const auto& completion : completer.complete(prefix, ctx.completionLimit)) {
+				os << completion.name;
+				if (all)
+					os << csync(color::gray) << " (" << alchlib2::GetNameKindName(completion.kind) << ", " << completion.count << (completion.count == 1 ? " ingredient)" : " ingredients)") << csync();
+				os << '\n';
+			}
+		}
+		break;
+	}
+	case Mode::Convert: {
+		const std::filesystem::path outputPath{ params.front() };
+		if (!alchlib2::Registry::WriteTo(outputPath, registry))
+			throw make_exception("Failed to write the registry to ", outputPath, "!");
+
+		os << "Wrote " << registry.size() << " ingredients to " << outputPath << '\n';
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief			Runs produces mode using a recipe database instead of a registry, which doesn't build any potions.
+ *					The output is the same as run_mode, as long as the database is current.
+ * @param os		The output stream.
+ * @param params	The effect names, which must have already been checked with validate_params.
+ * @param database	The recipe database to query.
+ * @param ctx		The formatter & options to use.
+ */
+inline void run_produces(std::ostream& os, std::vector<std::string> const& params, alchlib2::RecipeDatabase const& database, ModeContext const& ctx)
+{
+	const auto& csync{ ctx.fmt.csync };
+
+	for (const auto& name : params) {
+		const auto matches{ database.FindProducing(name, ctx.exact, ctx.minMagnitude) };
+
+		print_produces_header(os, name, ctx);
+		bool fst{ true };
+		for (const auto& match : matches) {
+			if (fst) fst = false;
+			else os << '\n';
+
+			std::vector<std::string_view> ingredientNames;
+			for (const auto id : database.GetIngredients(match.recipe))
+				ingredientNames.emplace_back(database.GetIngredientName(id));
+			std::vector<alchlib2::Effect> effects;
+			for (const auto& effect : database.GetEffects(match.recipe))
+				effects.emplace_back(database.GetEffect(effect));
+			print_produced_recipe(os, ingredientNames, database.GetPotionName(match.recipe), effects, ctx);
+		}
+
+		os << '\n' << csync(color::red) << '}' << csync() << '\n';
+		if (ctx.all)
+			os << csync(color::gray) << "Found " << matches.size() << " recipes in a database of " << database.size() << " recipes." << csync() << '\n';
+	}
+}
+
+/// @brief	Gets a string that identifies the game settings, perks & formula, which is hashed to check whether a recipe database is current.
+inline std::string get_settings_key(ModeContext const& ctx, alchlib2::perks::VanillaPerks const& perks)
+{
+	std::string key{ nlohmann::json(ctx.coreGameSettings).dump() };
+	key += nlohmann::json(perks).dump();
+	if (ctx.formula.has_value())
+		key += nlohmann::json(ctx.formula.value()).dump();
+	return key;
+}
+
+/// @brief	A single line of a query file.
+struct Query {
+	std::size_t lineNumber;
+	Mode mode;
+	std::vector<std::string> params;
+};
+
+/// @brief	Gets the mode with the given query file name, or Mode::None when there isn't one.
+inline Mode get_query_mode(std::string_view const name)
+{
+	if (name == "list") return Mode::List;
+	else if (name == "search") return Mode::Search;
+	else if (name == "smart") return Mode::SmartSearch;
+	else if (name == "build") return Mode::Build;
+	else if (name == "pairs") return Mode::Pairs;
+	else if (name == "best") return Mode::Best;
+	else if (name == "recipe") return Mode::Recipe;
+	else if (name == "produces") return Mode::Produces;
+	else if (name == "complete") return Mode::Complete;
+	return Mode::None;
+}
+
+/// @brief	Splits a line of a query file at whitespace, except inside of quotes.
+inline std::vector<std::string> split_query(std::string_view const line)
+{
+	std::vector<std::string> words;
+	std::string word;
+	bool inQuotes{ false }, inWord{ false };
+	for (const char c : line) {
+		if (c == '"') {
+			inQuotes = !inQuotes;
+			inWord = true;
+		}
+		else if (!inQuotes && std::isspace($c(unsigned char, c))) {
+			if (inWord)
+				words.emplace_back(std::move(word));
+			word.clear();
+			inWord = false;
+		}
+		else {
+			word += c;
+			inWord = true;
+		}
+	}
+	if (inQuotes)
+		throw make_exception("Unterminated quote!");
+	if (inWord)
+		words.emplace_back(std::move(word));
+	return words;
+}
+
+/**
+ * @brief			Calls func(lineNumber, words) for every line in a file that isn't empty or a comment, after splitting it with split_query.
+ * @param path		The path of the file.
+ * @param fileType	The type of file, which is included in error messages.
+ * @throws			ex::except when the file doesn't exist, or when func throws. The message includes the line number.
+ */
+template<typename TFunc>
+inline void for_each_line(std::filesystem::path const& path, std::string_view const fileType, TFunc&& func)
+{
+	if (!file::exists(path))
+		throw make_exception("Couldn't find ", fileType, ' ', path, "!");
+
+	std::stringstream ss{ file::read(path) };
+	std::size_t lineNumber{ 0 };
+	for (std::string line; std::getline(ss, line); ) {
+		++lineNumber;
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		if (const auto first{ line.find_first_not_of(" \t") }; first == std::string::npos || line[first] == '#')
+			continue;
+
+		try {
+			func(lineNumber, split_query(line));
+		} catch (const std::exception& ex) {
+			throw make_exception(ex.what(), " (Line ", lineNumber, " of ", fileType, ' ', path, ')');
+		}
+	}
+}
+
+/**
+ * @brief		Reads & validates every query in a query file.
+ * @param path	The path of the query file.
+ * @throws		ex::except when any query is invalid. The message includes the line number.
+ */
+inline std::vector<Query> read_queries(std::filesystem::path const& path)
+{
+	std::vector<Query> queries;
+	for_each_line(path, "query file", [&queries](std::size_t const lineNumber, std::vector<std::string>&& words) {
+		const auto mode{ get_query_mode(words.front()) };
+		if (mode == Mode::None)
+			throw make_exception("Unknown mode \"", words.front(), "\"!");
+
+		std::vector<std::string> params{ std::make_move_iterator(words.begin() + 1), std::make_move_iterator(words.end()) };
+		std::stringstream ignored;
+		validate_params(mode, params, ignored);
+		queries.emplace_back(Query{ lineNumber, mode, std::move(params) });
+	});
+	return queries;
+}
+
+/**
+ * @brief			Runs every query concurrently on a work-stealing pool, then writes their results in the same order as the queries.
+ *					Each query writes to its own output buffer, so the queries never share any mutable state.
+ * @param os		The output stream.
+ * @param queries	The queries to run.
+ * @param registry	The registry to run the queries against. This is shared by every query.
+ * @param ctx		The formatter, options & configs to use.
+ * @returns			The number of queries that failed. The error message of each failed query is written in its place.
+ */
+inline std::size_t run_queries(std::ostream& os, std::vector<Query> const& queries, alchlib2::RegistrySnapshot const& registry, ModeContext const& ctx)
+{
+	std::vector<std::string> results(queries.size());
+	std::vector<char> failed(queries.size(), false);
+
+	alchlib2::WorkStealingPool{}.for_each_index(queries.size(), [&](std::size_t const i) {
+		const auto& query{ queries[i] };
+		std::stringstream ss;
+		try {
+			if (query.mode == Mode::Build)
+				run_mode(ss, query.mode, query.params, resolve_ingredients(registry.GetRegistry(), query.params, ss, ctx), ctx);
+			else
+				run_mode(ss, query.mode, query.params, registry.GetRegistry(), ctx);
+		} catch (const std::exception& ex) {
+			ss << ctx.fmt.csync.get_error() << ex.what() << " (Line " << query.lineNumber << ")\n";
+			failed[i] = true;
+		}
+		results[i] = ss.str();
+	});
+
+	for (const auto& result : results)
+		os << result;
+	return $c(std::size_t, std::count(failed.begin(), failed.end(), true));
+}
+
+/// @brief	A single line of a recipe file.
+struct TableRecipe {
+	/// @brief	The indices of the ingredients in the registry.
+	std::vector<std::size_t> ingredients;
+	/// @brief	The names of the ingredients, joined with " + ".
+	std::string label;
+};
+
+/**
+ * @brief			Reads every recipe in a recipe file, and finds the ingredient that best fits each name.
+ * @param path		The path of the recipe file.
+ * @param registry	The registry to find the ingredients in.
+ * @throws			ex::except when any recipe is invalid. The message includes the line number.
+ */
+inline std::vector<TableRecipe> read_recipes(std::filesystem::path const& path, alchlib2::Registry const& registry)
+{
+	std::vector<TableRecipe> recipes;
+	for_each_line(path, "recipe file", [&](std::size_t, std::vector<std::string>&& names) {
+		if (names.size() < 2)
+			throw make_exception("Not enough ingredients were specified for a recipe. (Min 2)");
+
+		TableRecipe recipe;
+		for (const auto& name : names) {
+			const auto ingr{ registry.find_best_fit(name, true, false) };
+			if (ingr == registry.end())
+				throw make_exception(get_not_found_message(registry, name));
+
+			if (!recipe.label.empty())
+				recipe.label += " + ";
+			recipe.label += ingr->name;
+			recipe.ingredients.emplace_back($c(std::size_t, std::distance(registry.begin(), ingr)));
+		}
+		recipes.emplace_back(std::move(recipe));
+	});
+	return recipes;
+}
+
+/**
+ * @brief		Reads every profile in a profile file, and loads their configs.
+ * @param path	The path of the profile file.
+ * @throws		ex::except when any profile is invalid, or any of its configs can't be read. The message includes the line number.
+ */
+inline std::vector<alchlib2::Profile> read_profiles(std::filesystem::path const& path)
+{
+	const auto directory{ path.parent_path() };
+	const auto get_path{ [&directory](std::vector<std::string> const& words, std::size_t const index) -> std::optional<std::filesystem::path> {
+		if (index >= words.size() || words[index] == "-")
+			return std::nullopt;
+		return directory / words[index];
+	} };
+
+	std::vector<alchlib2::Profile> profiles;
+	for_each_line(path, "profile file", [&](std::size_t, std::vector<std::string>&& words) {
+		if (words.size() > 3)
+			throw make_exception("Too many paths were specified for profile \"", words.front(), "\"! (Max 2)");
+
+		alchlib2::Profile profile{ words.front(), {}, {} };
+		if (const auto gmstPath{ get_path(words, 1) }; gmstPath.has_value()) {
+			if (!file::exists(gmstPath.value()))
+				throw make_exception("Couldn't find game settings config ", gmstPath.value(), "!");
+			profile.gameSettings = alchlib2::AlchemyCoreGameSettings::ReadFrom(gmstPath.value());
+		}
+		if (const auto perksPath{ get_path(words, 2) }; perksPath.has_value()) {
+			if (!file::exists(perksPath.value()))
+				throw make_exception("Couldn't find perks config ", perksPath.value(), "!");
+			profile.perks = alchlib2::perks::VanillaPerks::ReadFrom(perksPath.value()).GetAllPerks();
+		}
+		else profile.perks = alchlib2::perks::VanillaPerks{}.GetAllPerks();
+		profiles.emplace_back(std::move(profile));
+	});
+	if (profiles.empty())
+		throw make_exception("Profile file ", path, " doesn't contain any profiles!");
+	return profiles;
+}
+
+/**
+ * @brief			Builds every recipe for every profile, then writes a table with one row per recipe & one column per profile.
+ *					Each cell shows the magnitude & duration of the strongest effect of the potion that the profile would make.
+ * @param os		The output stream.
+ * @param recipes	The recipes to build.
+ * @param registry	The registry that contains the recipes' ingredients.
+ * @param profiles	The profiles to build the recipes for.
+ * @param ctx		The formatter & options to use.
+ */
+inline void run_table(std::ostream& os, std::vector<TableRecipe> const& recipes, alchlib2::Registry const& registry, alchlib2::ProfileSet const& profiles, ModeContext const& ctx)
+{
+	const auto& csync{ ctx.fmt.csync };
+
+	// the common effects of each recipe are only found once, and shared by every profile
+	std::vector<std::vector<alchlib2::Potion>> potions(recipes.size());
+	alchlib2::WorkStealingPool{}.for_each_index(recipes.size(), [&](std::size_t const i) {
+		potions[i] = profiles.Build(registry, recipes[i].ingredients);
+	});
+
+	// format every cell first, so that the columns can be aligned
+	std::vector<std::vector<std::string>> cells(recipes.size() + 1);
+	cells.front().emplace_back("Recipe");
+	cells.front().emplace_back("Potion");
+	for (const auto& profile : profiles)
+		cells.front().emplace_back(profile.name);
+	for (std::size_t r{ 0 }; r < recipes.size(); ++r) {
+		auto& row{ cells[r + 1] };
+		row.emplace_back(recipes[r].label);
+		row.emplace_back(potions[r].front().name);
+		for (const auto& potion : potions[r]) {
+			if (potion.effects.empty()) {
+				row.emplace_back("-");
+				continue;
+			}
+			const auto& strongest{ potion.GetStrongestEffect() };
+			row.emplace_back(str::stringify(strongest.magnitude, strongest.duration == 0 ? "" : str::stringify(' ', strongest.duration, 's')));
+		}
+	}
+
+	std::vector<std::size_t> widths(cells.front().size(), 0);
+	for (const auto& row : cells)
+		for (std::size_t c{ 0 }; c < row.size(); ++c)
+			widths[c] = std::max(widths[c], row[c].size());
+
+	for (std::size_t r{ 0 }; r < cells.size(); ++r) {
+		if (r == 0) os << csync(color::bold);
+		for (std::size_t c{ 0 }; c < cells[r].size(); ++c) {
+			if (c != 0) {
+				os << csync(color::gray) << " | " << csync();
+				if (r == 0) os << csync(color::bold);
+			}
+			os << cells[r][c];
+			if (c + 1 != cells[r].size())
+				os << std::string(widths[c] - cells[r][c].size(), ' ');
+		}
+		if (r == 0) os << csync(color::no_bold);
+		os << '\n';
+	}
+}
+
+/**
+ * @brief	The arguments of one invocation, split at each "--" into one group per mode.
+ *			Options apply to every mode, whichever group they're given in; each group's mode & parameters only apply to that group.
+ */
+class ArgumentGroups {
+	std::vector<opt3::ArgManager> groups;
+
+	static opt3::ArgManager parse(const int argc, char** argv)
+	{
+		return{ argc, argv,
 			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'i', "ingr"),
 			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'g', "gmst"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'P', "perks"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'Q', "queries"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 't', "time-limit"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'T', "table"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'm', "profiles"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'F', "formula"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'M', "min-magnitude"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'd', "recipe-db"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'D', "build-recipe-db"),
+			opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'L', "limit"),
 			opt3::make_template(opt3::CaptureStyle::Disabled, opt3::ConflictStyle::Conflict, 'l', "list"),
 		};
+	}
+
+public:
+	ArgumentGroups(const int argc, char** argv)
+	{
+		std::vector<char*> group{ argv[0] };
+		for (int i{ 1 }; i <= argc; ++i) {
+			if (i == argc || std::string_view{ argv[i] } == "--") {
+				group.emplace_back(nullptr);
+				groups.emplace_back(parse($c(int, group.size() - 1), group.data()));
+				group.resize(1);
+			}
+			else group.emplace_back(argv[i]);
+		}
+	}
+
+	std::size_t size() const noexcept { return groups.size(); }
+	opt3::ArgManager const& operator[](std::size_t const index) const { return groups[index]; }
+	/// @brief	Checks whether no arguments were given at all.
+	bool empty() const { return std::all_of(groups.begin(), groups.end(), [](auto&& group) { return group.empty(); }); }
+
+	template<typename... TArgTypes, typename... TNames>
+	bool check_any(TNames const&... names) const
+	{
+		return std::any_of(groups.begin(), groups.end(), [&](auto&& group) { return group.template check_any<TArgTypes...>(names...); });
+	}
+	/// @brief	Gets the value of an option from the first group that has one.
+	template<typename... TArgTypes, typename... TNames>
+	std::optional<std::string> getv_any(TNames const&... names) const
+	{
+		for (const auto& group : groups)
+			if (auto value{ group.template getv_any<TArgTypes...>(names...) }; value.has_value())
+				return value;
+		return std::nullopt;
+	}
+	/// @brief	Gets the value of an option from the first group that has one, and converts it to T.
+	template<typename T, typename... TArgTypes, typename... TNames>
+	std::optional<T> castgetv_any(TNames const&... names) const
+	{
+		for (const auto& group : groups)
+			if (auto value{ group.template castgetv_any<T, TArgTypes...>(names...) }; value.has_value())
+				return value;
+		return std::nullopt;
+	}
+};
+
+/**
+ * @brief		Gets the mode specified by one group of arguments.
+ * @throws		ex::except when the group doesn't specify exactly one mode.
+ */
+inline Mode get_mode(opt3::ArgManager const& args)
+{
+	constexpr std::tuple<Mode, char, const char*> modes[]{
+		{ Mode::List, 'l', "list" },
+		{ Mode::Search, 's', "search" },
+		{ Mode::SmartSearch, 'S', "smart" },
+		{ Mode::Build, 'B', "build" },
+		{ Mode::Pairs, 'p', "pairs" },
+		{ Mode::Convert, 'c', "convert" },
+		{ Mode::Best, 'b', "best" },
+		{ Mode::Recipe, 'r', "recipe" },
+		{ Mode::Produces, 'E', "produces" },
+		{ Mode::Complete, 'C', "complete" },
+		{ Mode::Queries, 'Q', "queries" },
+		{ Mode::Table, 'T', "table" },
+		{ Mode::BuildRecipeDatabase, 'D', "build-recipe-db" },
+	};
+
+	Mode mode{ Mode::None };
+	for (const auto& [m, flag, name] : modes) {
+		if (!args.check_any<opt3::Flag, opt3::Option>(flag, name))
+			continue;
+		if (mode != Mode::None)
+			throw make_exception("Multiple modes cannot be specified at the same time! Separate modes with \"--\" to run them one after another.");
+		mode = m;
+	}
+	if (mode == Mode::None)
+		throw make_exception("No mode was specified!");
+	return mode;
+}
+
+/// @brief	One mode to run, and the inputs that it needs besides the registry & configs.
+struct Step {
+	Mode mode;
+	std::vector<std::string> params;
+	/// @brief	The path captured by the mode's own flag, for query, table & build-recipe-db modes.
+	std::optional<std::filesystem::path> path;
+	std::vector<Query> queries;
+	std::vector<alchlib2::Profile> profiles;
+};
+
+int main(const int argc, char** argv)
+{
+	color::sync csync;
+	try {
+		const ArgumentGroups args{ argc, argv };
 		const auto& [programPath, programName] { env::PATH{}.resolve_split(argv[0]) };
 
 		const std::filesystem::path registryPath{ args.castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('i', "ingr").value_or(std::filesystem::path{ "alch.ingredients" }) };
@@ -71,7 +1030,6 @@ int main(const int argc, char** argv)
 		const bool exact{ args.check_any<opt3::Flag, opt3::Option>('e', "exact") };
 
 		csync.setEnabled(!noColor);
-		keywordColors.setEnabled(!noColor);
 
 		if (const bool noArgs{ args.empty() }; noArgs || args.check_any<opt3::Flag, opt3::Option>('h', "help")) {
 			std::cout << help(programName.generic_string()) << std::endl;
@@ -87,156 +1045,183 @@ int main(const int argc, char** argv)
 			if (!file::exists(registryPath))
 				throw make_exception("Couldn't find a valid ingredients registry at ", registryPath, "!\n", shared::indent(10), "You can generate an ingredients registry with this tool:\n", shared::indent(10), "https://github.com/radj308/alch-registry-generator");
 
-			alchlib2::Registry registry{ alchlib2::Registry::ReadFrom(registryPath) };
-
-			// Find which exclusive mode the user specified
-			Mode mode{ Mode::None };
-
-			const auto& trySetMode{ [&mode](const Mode& m) {
-				if (mode != Mode::None) throw make_exception("Multiple modes cannot be specified at the same time!");
-				else mode = m;
+			// errors in one of several modes say which mode they're in
+			const auto rethrow_for_group{ [&args](std::size_t const index, std::exception const& ex) {
+				if (args.size() == 1)
+					throw;
+				throw make_exception(ex.what(), " (Mode ", index + 1, " of ", args.size(), ')');
 			} };
 
-			if (args.check_any<opt3::Flag, opt3::Option>('l', "list"))
-				trySetMode(Mode::List);
-			else if (args.check_any<opt3::Flag, opt3::Option>('s', "search"))
-				trySetMode(Mode::Search);
-			else if (args.check_any<opt3::Flag, opt3::Option>('S', "smart"))
-				trySetMode(Mode::SmartSearch);
-			else if (args.check_any<opt3::Flag, opt3::Option>('B', "build"))
-				trySetMode(Mode::Build);
-			else // user specified multiple modes:
-				throw make_exception("No mode was specified!");
-
-			// Get all uncaptured parameters
-			const auto& params{ args.getv_all<opt3::Parameter>() };
-
-			ObjectFormatter fmt{ color::setcolor::yellow, quiet, all };
-
-			// Execute mode-specific operations
-			switch (mode) {
-			case Mode::List: {
-				if (!params.empty()) { // if parameters WERE specified, show a warning message:
-					std::cerr << "Ignoring arguments: ";
-					bool fst{ true };
-					for (const auto& param : params) {
-						if (fst) fst = false;
-						else std::cerr << ", ";
-
-						std::cerr << '"' << param << '"';
-					}
+			// Find the mode of each group of arguments, and its uncaptured parameters
+			std::vector<Step> steps;
+			steps.reserve(args.size());
+			for (std::size_t i{ 0 }; i < args.size(); ++i) {
+				try {
+					Step step{ get_mode(args[i]), args[i].getv_all<opt3::Parameter>(), std::nullopt, {}, {} };
+					if (step.mode == Mode::Queries)
+						step.path = args[i].castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('Q', "queries");
+					else if (step.mode == Mode::Table)
+						step.path = args[i].castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('T', "table");
+					else if (step.mode == Mode::BuildRecipeDatabase)
+						step.path = args[i].castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('D', "build-recipe-db");
+					steps.emplace_back(std::move(step));
+				} catch (const std::exception& ex) {
+					rethrow_for_group(i, ex);
 				}
+			}
+			const auto any_step{ [&steps](auto&& pred) { return std::any_of(steps.begin(), steps.end(), pred); } };
 
-				std::cout << "Listing all ingredients:"
-					<< '\n' << csync(color::red) << '{' << csync() << '\n';
+			// produces mode doesn't need the registry at all when it's answered from a recipe database
+			const auto recipeDatabasePath{ args.castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('d', "recipe-db") };
+			const auto uses_recipe_database{ [&recipeDatabasePath](Step const& step) { return step.mode == Mode::Produces && recipeDatabasePath.has_value(); } };
 
-				bool fst{ true };
-				for (const auto& ingr : registry.Ingredients) {
-					if (fst) fst = false;
-					else std::cout << '\n';
-					fmt.print(std::cout, ingr);
-				}
+			// start reading the registry now so that it loads while the arguments are validated. It's only read once, however many modes there are.
+			// a lone build mode only needs the named ingredients, so it reads them individually using the registry's offset index.
+			// when any name doesn't match an ingredient, the whole registry is read instead, so that the name can be corrected.
+			const bool onlyBuild{ steps.size() == 1 && steps.front().mode == Mode::Build };
+			bool readBestFits{ false };
+			std::future<alchlib2::Registry> registryFuture;
+			if (onlyBuild) {
+				registryFuture = std::async(std::launch::async, [&registryPath, &params = steps.front().params, &readBestFits] {
+					const auto index{ alchlib2::RegistryIndex::LoadOrGenerate(registryPath) };
+					if (!std::all_of(params.begin(), params.end(), [&index](auto&& name) { return index.find_best_fit(name).has_value(); }))
+						return alchlib2::Registry::ReadFrom(registryPath);
+					readBestFits = true;
+					return index.ReadBestFits(registryPath, params);
+				});
+			}
+			else if (!std::all_of(steps.begin(), steps.end(), uses_recipe_database))
+				registryFuture = std::async(std::launch::async, &alchlib2::Registry::ReadFrom, registryPath);
 
-				std::cout << "\n" << csync(color::red) << '}' << csync() << '\n';
-				break;
+			// build, pairs & recipe modes (and query files, which may contain them) also need the game settings & perks configs, which are read alongside the registry
+			std::future<alchlib2::AlchemyCoreGameSettings> coreGameSettingsFuture;
+			std::future<alchlib2::perks::VanillaPerks> perksFuture;
+			const bool hasProfiles{ args.check_any<opt3::Flag, opt3::Option>('m', "profiles") };
+			if (any_step([&hasProfiles](Step const& step) {
+				const auto mode{ step.mode };
+				return mode == Mode::Build || mode == Mode::Pairs || mode == Mode::Recipe || mode == Mode::Produces || mode == Mode::Queries || mode == Mode::BuildRecipeDatabase || (mode == Mode::Table && !hasProfiles);
+			})) {
+				coreGameSettingsFuture = std::async(std::launch::async, [path = args.castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('g', "gmst").value_or("alch.gmst")] {
+					return file::exists(path) ? alchlib2::AlchemyCoreGameSettings::ReadFrom(path) : alchlib2::AlchemyCoreGameSettings{};
+				});
+				perksFuture = std::async(std::launch::async, [path = args.castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('P', "perks").value_or("alch.perks")] {
+					return file::exists(path) ? alchlib2::perks::VanillaPerks::ReadFrom(path) : alchlib2::perks::VanillaPerks{};
+				});
 			}
-			case Mode::Search: {
-				if (params.empty())
-					throw make_exception("Not enough search terms were specified for search mode. (Min 1)");
 
-				for (const auto& name : params) {
-					const auto results{ registry.copy_inclusive_filter(name, exact, true, true) };
+			// Validate the parameters of every mode while the config files are loading, so that none of them run when any are invalid
+			for (std::size_t i{ 0 }; i < steps.size(); ++i) {
+				auto& step{ steps[i] };
+				try {
+					if (step.mode == Mode::Queries)
+						step.queries = read_queries(step.path.value());
+					else if (step.mode == Mode::Table) {
+						if (const auto profilesPath{ args.castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('m', "profiles") }; profilesPath.has_value())
+							step.profiles = read_profiles(profilesPath.value());
+					}
+					else
+						validate_params(step.mode, step.params, std::cerr);
+				} catch (const std::exception& ex) {
+					rethrow_for_group(i, ex);
+				}
+			}
 
-					std::cout << "Showing results for: \"" << csync(fmt.searchTermHighlightColor) << name << csync() << "\"\n"
-						<< csync(color::red) << '{' << csync() << '\n';
+			std::optional<std::chrono::steady_clock::duration> timeLimit;
+			if (const auto seconds{ args.getv_any<opt3::Flag, opt3::Option>('t', "time-limit") }; seconds.has_value()) {
+				double value{ 0.0 };
+				try {
+					value = str::stod(seconds.value());
+				} catch (...) {}
+				if (!(value > 0.0))
+					throw make_exception("Invalid time limit \"", seconds.value(), "\"! (Must be a number of seconds greater than 0)");
+				timeLimit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>{ value });
+			}
 
-					bool fst{ true };
-					for (const auto& ingr : results.Ingredients) {
-						if (fst) fst = false;
-						else std::cout << '\n';
-						fmt.print(std::cout, ingr, name, exact);
-					}
+			float minMagnitude{ 0.0f };
+			if (const auto magnitude{ args.getv_any<opt3::Flag, opt3::Option>('M', "min-magnitude") }; magnitude.has_value()) {
+				double value{ -1.0 };
+				try {
+					value = str::stod(magnitude.value());
+				} catch (...) {}
+				if (!(value >= 0.0))
+					throw make_exception("Invalid minimum magnitude \"", magnitude.value(), "\"! (Must be a number greater than or equal to 0)");
+				minMagnitude = $c(float, value);
+			}
 
-					std::cout << "\n" << csync(color::red) << '}' << csync() << '\n';
-				}
-				break;
-			}
-			case Mode::SmartSearch: {
-				if (params.empty())
-					throw make_exception("Not enough effects were specified for smart search mode. (Min 1)");
-
-				std::cout << "Showing results for: ";
-				bool fst{ true };
-				for (const auto& name : params) {
-					if (fst) fst = false;
-					else std::cout << ", ";
-					std::cout << '\"' << csync(fmt.searchTermHighlightColor) << name << csync() << '\"';
-				}
-				std::cout << '\n' << csync(color::red) << '{' << csync() << '\n';
+			std::size_t completionLimit{ 10 };
+			if (const auto limit{ args.getv_any<opt3::Flag, opt3::Option>('L', "limit") }; limit.has_value()) {
+				double value{ -1.0 };
+				try {
+					value = str::stod(limit.value());
+				} catch (...) {}
+				if (!(value >= 0.0) || value != std::floor(value))
+					throw make_exception("Invalid limit \"", limit.value(), "\"! (Must be a whole number; 0 means no limit)");
+				completionLimit = $c(std::size_t, value);
+			}
 
-				const auto results{ registry.copy_if([&params, &exact](alchlib2::Ingredient const& ingredient) {
-					return std::all_of(params.begin(), params.end(), [&ingredient, &exact](auto&& name) { return ingredient.AnyEffectIsSimilarTo(name, exact); });
-				}) };
+			const ObjectFormatter fmt{ color::setcolor::yellow, quiet, all, !noColor };
+			ModeContext ctx{ fmt, exact, all, {}, {}, timeLimit, minMagnitude, completionLimit, {}, {} };
+			if (coreGameSettingsFuture.valid())
+				ctx.coreGameSettings = coreGameSettingsFuture.get();
+			alchlib2::perks::VanillaPerks vanillaPerks;
+			if (perksFuture.valid()) {
+				vanillaPerks = perksFuture.get();
+				ctx.perks = vanillaPerks.GetAllPerks();
+			}
+			if (const auto formulaPath{ args.castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('F', "formula") }; formulaPath.has_value()) {
+				if (!file::exists(formulaPath.value()))
+					throw make_exception("Couldn't find formula config ", formulaPath.value(), "!");
+				ctx.formula = alchlib2::FormulaConfig::ReadFrom(formulaPath.value());
+				// compiling the formula also checks it for errors before any mode runs
+				ctx.formulaProgram = ctx.formula->Compile(ctx.coreGameSettings);
+			}
 
-				fst = true;
-				for (const auto& ingr : results.Ingredients) {
-					if (fst) fst = false;
-					else std::cout << '\n';
-					fmt.print(std::cout, ingr, params, exact);
-				}
+			// every mode shares the same registry
+			const alchlib2::RegistrySnapshot registry{ registryFuture.valid() ? registryFuture.get() : alchlib2::Registry{} };
 
-				std::cout << '\n' << csync(color::red) << '}' << csync() << '\n';
-				break;
-			}
-			case Mode::Build: {
-				if (params.size() < 2)
-					throw make_exception("Not enough ingredients were specified for build mode. (Min 2)");
-				
-				// retrieve the game settings config:
-				alchlib2::AlchemyCoreGameSettings coreGameSettings{};
-
-				if (const auto gameSettingsConfigPath{ args.castgetv_any<std::filesystem::path, opt3::Flag, opt3::Option>('g', "gmst").value_or("alch.gmst") };
-					file::exists(gameSettingsConfigPath))
-					coreGameSettings = alchlib2::AlchemyCoreGameSettings::ReadFrom(gameSettingsConfigPath);
-
-				// collect all the ingredients:
-				const auto& results{ registry.find_best_fit(params, true, false) };
-				alchlib2::PotionBuilder builder{ coreGameSettings };
-				alchlib2::perks::VanillaPerks vanillaPerks{};
-				const auto potion{ builder.Build(results.Ingredients, vanillaPerks.GetAllPerks()) };
-
-				// print input ingredients:
-				std::cout << "Combining ingredients:" << '\n' << csync(color::red) << '{' << csync() << '\n';
-				bool fst{ true };
-				for (const auto& ingr : results.Ingredients) {
-					if (fst) fst = false;
-					else std::cout << '\n';
-					fmt.print(std::cout, ingr, params, exact);
-				}
-				std::cout << '\n' << csync(color::red) << '}' << csync() << '\n';
-
-				// print potion name & alchemy stats
-				std::cout << "Produces: \"" << csync(color::bold) << potion.name << csync(color::no_bold) << "\"\n";
-				if (all) {
-					std::cout
-						<< csync(color::gray) << "With alchemy stats:" << '\n'
-						<< "  Skill:     " << csync(color::green) << coreGameSettings.fAlchemyAV.value << csync(color::gray) << '\n'
-						<< "  Modifier:  " << csync(color::green) << coreGameSettings.fAlchemyMod.value << csync() << '\n';
-				}
+			// Execute mode-specific operations, in order. The output of each mode is separated by an empty line.
+			int exitCode{ 0 };
+			for (std::size_t i{ 0 }; i < steps.size(); ++i) {
+				auto& step{ steps[i] };
+				if (i != 0)
+					std::cout << '\n';
 
-				// print effects:
-				std::cout << "Effects:" << '\n' << csync(color::red) << '{' << csync() << '\n';
-				fst = true;
-				for (const auto& effect : potion.effects) {
-					if (fst) fst = false;
-					else std::cout << '\n';
-					fmt.print(std::cout, effect);
-				}
-				std::cout << '\n' << csync(color::red) << '}' << csync() << '\n';
+				try {
+					if (step.mode == Mode::Queries) {
+						if (const auto failedCount{ run_queries(std::cout, step.queries, registry, ctx) }; failedCount != 0) {
+							std::cerr << csync.get_error() << failedCount << " of " << step.queries.size() << " queries failed!" << std::endl;
+							exitCode = 1;
+						}
+					}
+					else if (step.mode == Mode::Table) {
+						// without a profile file, the configs given by --gmst & --perks are the only profile
+						if (step.profiles.empty())
+							step.profiles.emplace_back(alchlib2::Profile{ "Default", ctx.coreGameSettings, vanillaPerks.GetAllPerks() });
 
-				break;
-			}
+						const auto recipes{ read_recipes(step.path.value(), registry.GetRegistry()) };
+						run_table(std::cout, recipes, registry.GetRegistry(), alchlib2::ProfileSet{ std::move(step.profiles), ctx.formula }, ctx);
+					}
+					else if (step.mode == Mode::BuildRecipeDatabase) {
+						const auto& outputPath{ step.path.value() };
+						const auto count{ alchlib2::RecipeDatabase::Build(outputPath, registry.GetRegistry(), ctx.make_builder(), ctx.perks, alchlib2::RecipeDatabase::MakeStamp(registryPath, get_settings_key(ctx, vanillaPerks))) };
+						std::cout << "Wrote " << count << " recipes to " << outputPath << '\n';
+					}
+					else if (uses_recipe_database(step)) {
+						if (!file::exists(recipeDatabasePath.value()))
+							throw make_exception("Couldn't find recipe database ", recipeDatabasePath.value(), "!");
+						const alchlib2::RecipeDatabase database{ recipeDatabasePath.value() };
+						if (!database.IsCurrent(registryPath, get_settings_key(ctx, vanillaPerks)))
+							throw make_exception("Recipe database ", recipeDatabasePath.value(), " is out of date! Rebuild it with --build-recipe-db.");
+						run_produces(std::cout, step.params, database, ctx);
+					}
+					else if (step.mode == Mode::Build && !readBestFits)
+						run_mode(std::cout, step.mode, step.params, resolve_ingredients(registry.GetRegistry(), step.params, std::cout, ctx), ctx);
+					else run_mode(std::cout, step.mode, step.params, registry.GetRegistry(), ctx);
+				} catch (const std::exception& ex) {
+					rethrow_for_group(i, ex);
+				}
 			}
+			return exitCode;
 		}
 
 		return 0;
@@ -0,0 +1,142 @@
+#pragma once
+/**
+ * @file	BKTree.hpp
+ * @author	radj307
+ * @brief	Burkhard-Keller tree of case-folded names, for finding the names within an edit distance of a misspelled one.
+ */
+#include "CaseInsensitive.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace alchlib2 {
+	/**
+	 * @brief	Gets the Levenshtein distance between two strings, which is the number of single-character insertions, deletions &
+	 *			substitutions needed to turn one into the other.
+	 */
+	inline std::size_t edit_distance(std::string_view const l, std::string_view const r)
+	{
+		if (l.size() < r.size())
+			return edit_distance(r, l);
+
+		// only the previous row of the table is needed; r is the shorter string, so the rows are as short as possible
+		std::vector<std::size_t> row(r.size() + 1);
+		for (std::size_t j{ 0 }; j < row.size(); ++j)
+			row[j] = j;
+		for (std::size_t i{ 1 }; i <= l.size(); ++i) {
+			std::size_t diagonal{ row[0] };
+			row[0] = i;
+			for (std::size_t j{ 1 }; j <= r.size(); ++j) {
+				const auto above{ row[j] };
+				row[j] = std::min({ above + 1, row[j - 1] + 1, diagonal + (l[i - 1] == r[j - 1] ? 0 : 1) });
+				diagonal = above;
+			}
+		}
+		return row.back();
+	}
+
+	/**
+	 * @brief	Stores case-folded keys so that every key within an edit distance of a search term can be found without comparing the
+	 *			term to every key.
+	 *
+	 *			Each child of a node is labelled with its distance from that node. Since edit distance obeys the triangle inequality,
+	 *			a search for keys within maxDistance of a term that is d from a node only needs to visit the children labelled
+	 *			[d - maxDistance, d + maxDistance], which skips most of the tree for small distances.
+	 */
+	class BKTree {
+	public:
+		struct Match {
+			/// @brief	The value that was inserted with the key.
+			std::uint32_t value;
+			/// @brief	The edit distance between the key & the search term.
+			std::uint32_t distance;
+		};
+
+	private:
+		struct Node {
+			std::string key;
+			/// @brief	The values of every key that folds to this one.
+			std::vector<std::uint32_t> values;
+			/// @brief	The distance label & node index of each child.
+			std::vector<std::pair<std::uint32_t, std::uint32_t>> children;
+		};
+		std::vector<Node> nodes;
+
+		static std::string fold(std::string_view const s)
+		{
+			std::string folded{ s };
+			std::transform(folded.begin(), folded.end(), folded.begin(), ci::tolower);
+			return folded;
+		}
+
+	public:
+		BKTree() = default;
+
+		std::size_t size() const noexcept { return nodes.size(); }
+		bool empty() const noexcept { return nodes.empty(); }
+
+		/// @brief	Adds a key & its value. Keys are compared case-insensitively; a key that's already in the tree gets another value.
+		void insert(std::string_view const key, std::uint32_t const value)
+		{
+			auto folded{ fold(key) };
+			if (nodes.empty()) {
+				nodes.emplace_back(Node{ std::move(folded), { value }, {} });
+				return;
+			}
+
+			for (std::size_t current{ 0 }; ; ) {
+				const auto distance{ $c(std::uint32_t, edit_distance(folded, nodes[current].key)) };
+				if (distance == 0) {
+					nodes[current].values.emplace_back(value);
+					return;
+				}
+				const auto& children{ nodes[current].children };
+				const auto child{ std::find_if(children.begin(), children.end(), [&distance](auto&& it) { return it.first == distance; }) };
+				if (child == children.end()) {
+					const auto index{ $c(std::uint32_t, nodes.size()) };
+					nodes[current].children.emplace_back(distance, index);
+					nodes.emplace_back(Node{ std::move(folded), { value }, {} });
+					return;
+				}
+				current = child->second;
+			}
+		}
+
+		/**
+		 * @brief				Finds the values of every key within the given edit distance of a term.
+		 * @param term			The term to search for. Case is ignored.
+		 * @param maxDistance	The largest edit distance to include.
+		 * @returns				The matches, closest first. Matches with the same distance are in ascending order of their values.
+		 */
+		std::vector<Match> find(std::string_view const term, std::size_t const maxDistance) const
+		{
+			std::vector<Match> matches;
+			if (nodes.empty())
+				return matches;
+
+			const auto folded{ fold(term) };
+			std::vector<std::uint32_t> stack{ 0 };
+			while (!stack.empty()) {
+				const auto& node{ nodes[stack.back()] };
+				stack.pop_back();
+
+				const auto distance{ edit_distance(folded, node.key) };
+				if (distance <= maxDistance)
+					for (const auto value : node.values)
+						matches.emplace_back(Match{ value, $c(std::uint32_t, distance) });
+
+				const auto min{ distance > maxDistance ? distance - maxDistance : 0 }, max{ distance + maxDistance };
+				for (const auto& [label, child] : node.children)
+					if (label >= min && label <= max)
+						stack.emplace_back(child);
+			}
+
+			std::sort(matches.begin(), matches.end(), [](auto&& l, auto&& r) { return l.distance < r.distance || (l.distance == r.distance && l.value < r.value); });
+			return matches;
+		}
+	};
+}
@@ -0,0 +1,175 @@
+#pragma once
+/**
+ * @file	CaseInsensitive.hpp
+ * @author	radj307
+ * @brief	ASCII case-insensitive string comparison & search functions that operate on string views without allocating.
+ *			SSE2 is used at runtime when it is available.
+ */
+#include <sysarch.h>
+
+#include <bit>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ALCHLIB2_CI_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace alchlib2::ci {
+	/// @brief	Converts an uppercase ASCII character to lowercase. All other characters are returned unchanged.
+	constexpr char tolower(char const c) noexcept
+	{
+		return (c >= 'A' && c <= 'Z') ? $c(char, c + ('a' - 'A')) : c;
+	}
+
+	namespace detail {
+	#ifdef ALCHLIB2_CI_SSE2
+		/// @brief	Converts all uppercase ASCII characters in a 16-byte vector to lowercase.
+		inline __m128i tolower16(__m128i const v) noexcept
+		{
+			// bytes >= 0x80 are negative when compared as signed, so they are never considered uppercase
+			const __m128i isUpper{ _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1))) };
+			return _mm_or_si128(v, _mm_and_si128(isUpper, _mm_set1_epi8(0x20)));
+		}
+		inline __m128i load16(char const* p) noexcept
+		{
+			return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+		}
+	#endif
+
+		/// @brief	Compares the first n characters of l & r for equality. Both must have at least n characters.
+		constexpr bool equals_n(char const* l, char const* r, std::size_t const n) noexcept
+		{
+			std::size_t i{ 0 };
+		#ifdef ALCHLIB2_CI_SSE2
+			if (!std::is_constant_evaluated()) {
+				for (; i + 16 <= n; i += 16) {
+					if (_mm_movemask_epi8(_mm_cmpeq_epi8(tolower16(load16(l + i)), tolower16(load16(r + i)))) != 0xFFFF)
+						return false;
+				}
+			}
+		#endif
+			for (; i < n; ++i)
+				if (tolower(l[i]) != tolower(r[i]))
+					return false;
+			return true;
+		}
+	}
+
+	/**
+	 * @brief		Checks if two strings are equal, ignoring ASCII case.
+	 * @returns		true when l and r are equal when compared case-insensitively; otherwise false.
+	 */
+	constexpr bool equals(std::string_view const l, std::string_view const r) noexcept
+	{
+		return l.size() == r.size() && detail::equals_n(l.data(), r.data(), l.size());
+	}
+
+	/**
+	 * @brief		Lexicographically compares two strings, ignoring ASCII case.
+	 * @returns		A negative value when l sorts before r, 0 when they are equal, or a positive value when l sorts after r.
+	 *				This gives the same result as comparing the lowercased strings with std::string::compare.
+	 */
+	constexpr int compare(std::string_view const l, std::string_view const r) noexcept
+	{
+		const auto n{ l.size() < r.size() ? l.size() : r.size() };
+		for (std::size_t i{ 0 }; i < n; ++i) {
+			const auto lc{ $c(unsigned char, tolower(l[i])) }, rc{ $c(unsigned char, tolower(r[i])) };
+			if (lc != rc)
+				return lc < rc ? -1 : 1;
+		}
+		return l.size() == r.size() ? 0 : (l.size() < r.size() ? -1 : 1);
+	}
+
+	namespace detail {
+		/**
+		 * @brief					Implementation of find & find_in_folded.
+		 * @tparam FoldHaystack		When false, the haystack is assumed to already be lowercase.
+		 */
+		template<bool FoldHaystack>
+		constexpr std::size_t find_impl(std::string_view const haystack, std::string_view const needle) noexcept
+		{
+			if (needle.empty())
+				return 0;
+			if (needle.size() > haystack.size())
+				return std::string_view::npos;
+
+			const auto n{ needle.size() };
+			const auto last{ haystack.size() - n }; //< the last valid starting position
+			std::size_t i{ 0 };
+		#ifdef ALCHLIB2_CI_SSE2
+			if (!std::is_constant_evaluated()) {
+				const auto load{ [](char const* p) { if constexpr (FoldHaystack) return tolower16(load16(p)); else return load16(p); } };
+				// compare the first & last characters of the needle against 16 candidate positions at once
+				const __m128i first{ _mm_set1_epi8(tolower(needle.front())) }, back{ _mm_set1_epi8(tolower(needle.back())) };
+				for (; i + (n - 1) + 16 <= haystack.size(); i += 16) {
+					const __m128i blockFirst{ load(haystack.data() + i) };
+					const __m128i blockBack{ load(haystack.data() + i + n - 1) };
+					for (unsigned mask{ $c(unsigned, _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockBack, back)))) }; mask != 0; mask &= mask - 1) {
+						const auto pos{ i + $c(std::size_t, std::countr_zero(mask)) };
+						if (n <= 2 || equals_n(haystack.data() + pos + 1, needle.data() + 1, n - 2))
+							return pos;
+					}
+				}
+			}
+		#endif
+			for (; i <= last; ++i)
+				if (equals_n(haystack.data() + i, needle.data(), n))
+					return i;
+			return std::string_view::npos;
+		}
+	}
+
+	/**
+	 * @brief			Finds the first occurrence of a substring, ignoring ASCII case.
+	 * @param haystack	The string to search.
+	 * @param needle	The string to search for.
+	 * @returns			The position of the first match, or std::string_view::npos when there isn't one.
+	 */
+	constexpr std::size_t find(std::string_view const haystack, std::string_view const needle) noexcept
+	{
+		return detail::find_impl<true>(haystack, needle);
+	}
+	/**
+	 * @brief			Finds the first occurrence of a substring in a string that is already lowercase, ignoring the needle's ASCII case.
+	 *					This is faster than find() for repeated searches of the same large buffer.
+	 * @param haystack	The string to search. Must not contain any uppercase ASCII characters.
+	 * @param needle	The string to search for.
+	 * @returns			The position of the first match, or std::string_view::npos when there isn't one.
+	 */
+	constexpr std::size_t find_in_folded(std::string_view const haystack, std::string_view const needle) noexcept
+	{
+		return detail::find_impl<false>(haystack, needle);
+	}
+
+	/**
+	 * @brief			Checks if a string contains a substring, ignoring ASCII case.
+	 * @returns			true when needle appears anywhere in haystack; otherwise false.
+	 */
+	constexpr bool contains(std::string_view const haystack, std::string_view const needle) noexcept
+	{
+		return find(haystack, needle) != std::string_view::npos;
+	}
+
+	/**
+	 * @brief			Checks if a string starts with a prefix, ignoring ASCII case.
+	 * @returns			true when str begins with prefix; otherwise false.
+	 */
+	constexpr bool starts_with(std::string_view const str, std::string_view const prefix) noexcept
+	{
+		return str.size() >= prefix.size() && detail::equals_n(str.data(), prefix.data(), prefix.size());
+	}
+
+	/**
+	 * @brief		Checks whether two strings match, ignoring ASCII case.
+	 * @param str	The string being tested.
+	 * @param term	The search term.
+	 * @param exact	When true, the strings must be equal; otherwise str must contain term.
+	 */
+	constexpr bool matches(std::string_view const str, std::string_view const term, bool const exact) noexcept
+	{
+		return exact ? equals(str, term) : contains(str, term);
+	}
+}
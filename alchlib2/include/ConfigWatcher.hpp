@@ -0,0 +1,242 @@
+#pragma once
+/**
+ * @file	ConfigWatcher.hpp
+ * @author	radj307
+ * @brief	Reloads the registry, game settings & perks config files in the background whenever they change, and publishes them as immutable snapshots.
+ */
+#include "RegistrySnapshot.hpp"
+#include "GameSetting.hpp"
+#include "perks/VanillaPerks.h"
+
+#include <fileio.hpp>
+#include <make_exception.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#define ALCHLIB2_CONFIGWATCHER_INOTIFY
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace alchlib2 {
+	/// @brief	One consistent version of every config file. Snapshots are never modified after they're published.
+	struct ConfigSnapshot {
+		/// @brief	The registry, with all of its indexes already built.
+		RegistrySnapshot registry;
+		AlchemyCoreGameSettings gameSettings;
+		perks::VanillaPerks perks;
+		/// @brief	Starts at 0 and is incremented each time a new snapshot is published.
+		std::uint64_t generation{ 0 };
+	};
+
+	/**
+	 * @brief	Watches the registry, game settings & perks config files, and reloads them on a background thread when they change.
+	 *
+	 *			Readers call GetSnapshot() to get the current snapshot, which stays valid for as long as they hold it; a query that started
+	 *			before a reload finishes on the snapshot it started with. Reloaded files are fully parsed and indexed before the new snapshot
+	 *			is published with a single atomic store, so readers never see a partially-loaded registry and never wait for a reload.
+	 *
+	 *			On Linux, changes are detected with inotify on the files' parent directories, which also catches editors that save by
+	 *			replacing the file. Elsewhere, the files' last write times are polled.
+	 */
+	class ConfigWatcher {
+	public:
+		struct Paths {
+			std::filesystem::path registry;
+			/// @brief	When this file doesn't exist, the default game settings are used.
+			std::filesystem::path gameSettings;
+			/// @brief	When this file doesn't exist, the default perks are used.
+			std::filesystem::path perks;
+		};
+
+		/// @brief	Called on the background thread after each new snapshot is published.
+		using reload_callback = std::function<void(std::shared_ptr<const ConfigSnapshot> const&)>;
+		/// @brief	Called on the background thread when reloading fails. The previous snapshot remains current.
+		using error_callback = std::function<void(std::exception const&)>;
+
+		/// @brief	Changes are collected for this long after the first one is seen before reloading, since saving a file often causes several events.
+		static constexpr std::chrono::milliseconds Debounce{ 100 };
+		/// @brief	How often the background thread checks whether it should stop, and, without inotify, how often the files are checked.
+		static constexpr std::chrono::milliseconds PollInterval{ 250 };
+
+	private:
+		Paths paths;
+		reload_callback onReload;
+		error_callback onError;
+		std::atomic<std::shared_ptr<const ConfigSnapshot>> current;
+		std::jthread thread;
+
+		enum ChangedFiles : std::uint8_t {
+			None = 0,
+			RegistryFile = 1,
+			GameSettingsFile = 2,
+			PerksFile = 4,
+			AllFiles = RegistryFile | GameSettingsFile | PerksFile,
+		};
+
+		/**
+		 * @brief			Loads the changed files, reusing the unchanged parts of the previous snapshot.
+		 * @param previous	The previous snapshot, or nullptr when loading for the first time.
+		 * @param changed	Which files to reload. Ignored when previous is nullptr.
+		 */
+		std::shared_ptr<const ConfigSnapshot> load(std::shared_ptr<const ConfigSnapshot> const& previous, std::uint8_t changed) const
+		{
+			if (previous == nullptr)
+				changed = AllFiles;
+
+			auto next{ previous == nullptr ? std::make_shared<ConfigSnapshot>() : std::make_shared<ConfigSnapshot>(*previous) };
+			if (changed & RegistryFile)
+				next->registry = RegistrySnapshot::ReadFrom(paths.registry, true);
+			if (changed & GameSettingsFile)
+				next->gameSettings = file::exists(paths.gameSettings) ? AlchemyCoreGameSettings::ReadFrom(paths.gameSettings) : AlchemyCoreGameSettings{};
+			if (changed & PerksFile)
+				next->perks = file::exists(paths.perks) ? perks::VanillaPerks::ReadFrom(paths.perks) : perks::VanillaPerks{};
+			if (previous != nullptr)
+				next->generation = previous->generation + 1;
+			return next;
+		}
+
+		/// @brief	Reloads the changed files and publishes the result, or reports the error.
+		void reload(std::uint8_t const changed)
+		{
+			try {
+				auto next{ load(current.load(), changed) };
+				current.store(next);
+				if (onReload) onReload(next);
+			} catch (const std::exception& ex) {
+				if (onError) onError(ex);
+			}
+		}
+
+		/// @brief	Gets which of the watched files has the given path.
+		std::uint8_t which(std::filesystem::path const& path) const
+		{
+			std::uint8_t changed{ None };
+			if (path == paths.registry) changed |= RegistryFile;
+			if (path == paths.gameSettings) changed |= GameSettingsFile;
+			if (path == paths.perks) changed |= PerksFile;
+			return changed;
+		}
+
+	#ifdef ALCHLIB2_CONFIGWATCHER_INOTIFY
+		void watch(std::stop_token const& stop)
+		{
+			const int fd{ inotify_init1(IN_NONBLOCK | IN_CLOEXEC) };
+			if (fd == -1)
+				throw make_exception("inotify_init1 failed with error code ", errno, '!');
+
+			// watch each directory once; wd maps watch descriptors back to directories
+			std::vector<std::pair<int, std::filesystem::path>> wd;
+			for (const auto& path : { paths.registry, paths.gameSettings, paths.perks }) {
+				if (path.empty()) continue;
+				const auto dir{ path.parent_path().empty() ? std::filesystem::path{ "." } : path.parent_path() };
+				if (std::any_of(wd.begin(), wd.end(), [&dir](auto&& p) { return p.second == dir; }))
+					continue;
+				if (const int w{ inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM) }; w != -1)
+					wd.emplace_back(w, dir);
+			}
+
+			alignas(inotify_event) char buffer[4096];
+			std::uint8_t pending{ None };
+			std::chrono::steady_clock::time_point firstChange;
+
+			while (!stop.stop_requested()) {
+				pollfd pfd{ fd, POLLIN, 0 };
+				const auto timeout{ pending == None ? PollInterval : Debounce };
+				if (poll(&pfd, 1, $c(int, timeout.count())) > 0 && (pfd.revents & POLLIN)) {
+					for (ssize_t len; (len = read(fd, buffer, sizeof(buffer))) > 0; ) {
+						for (char* p{ buffer }; p < buffer + len; ) {
+							const auto* event{ reinterpret_cast<inotify_event const*>(p) };
+							if (event->len > 0) {
+								if (const auto dir{ std::find_if(wd.begin(), wd.end(), [event](auto&& pr) { return pr.first == event->wd; }) }; dir != wd.end()) {
+									if (const auto changed{ which(dir->second / event->name) }; changed != None) {
+										if (pending == None)
+											firstChange = std::chrono::steady_clock::now();
+										pending |= changed;
+									}
+								}
+							}
+							p += sizeof(inotify_event) + event->len;
+						}
+					}
+				}
+
+				if (pending != None && std::chrono::steady_clock::now() - firstChange >= Debounce) {
+					reload(pending);
+					pending = None;
+				}
+			}
+			close(fd);
+		}
+	#else
+		void watch(std::stop_token const& stop)
+		{
+			const auto get_time{ [](std::filesystem::path const& path) {
+				std::error_code ec;
+				return std::filesystem::last_write_time(path, ec);
+			} };
+			std::filesystem::file_time_type times[]{ get_time(paths.registry), get_time(paths.gameSettings), get_time(paths.perks) };
+
+			while (!stop.stop_requested()) {
+				std::this_thread::sleep_for(PollInterval);
+
+				std::uint8_t changed{ None };
+				for (std::uint8_t i{ 0 }; const auto& path : { paths.registry, paths.gameSettings, paths.perks }) {
+					if (const auto time{ get_time(path) }; time != times[i]) {
+						times[i] = time;
+						changed |= $c(std::uint8_t, 1u << i);
+					}
+					++i;
+				}
+				if (changed != None)
+					reload(changed);
+			}
+		}
+	#endif
+
+	public:
+		/**
+		 * @brief			Loads every config file, then starts watching them for changes.
+		 * @param paths		The files to watch. Paths are made absolute so that they can be matched against change events.
+		 * @param onReload	Optional callback for each newly published snapshot.
+		 * @param onError	Optional callback for reloads that fail.
+		 * @throws			Any exception thrown while loading the files for the first time.
+		 */
+		ConfigWatcher(Paths const& paths, reload_callback onReload = {}, error_callback onError = {}) :
+			paths{ std::filesystem::absolute(paths.registry).lexically_normal(), paths.gameSettings.empty() ? paths.gameSettings : std::filesystem::absolute(paths.gameSettings).lexically_normal(), paths.perks.empty() ? paths.perks : std::filesystem::absolute(paths.perks).lexically_normal() },
+			onReload{ std::move(onReload) },
+			onError{ std::move(onError) },
+			current{ load(nullptr, AllFiles) }
+		{
+			thread = std::jthread{ [this](std::stop_token stop) {
+				try {
+					watch(stop);
+				} catch (const std::exception& ex) {
+					if (this->onError) this->onError(ex);
+				}
+			} };
+		}
+		ConfigWatcher(ConfigWatcher const&) = delete;
+		ConfigWatcher& operator=(ConfigWatcher const&) = delete;
+		/// @brief	Stops watching. Blocks until the background thread exits, which takes at most PollInterval plus any reload in progress.
+		~ConfigWatcher() = default;
+
+		/// @brief	Gets the most recently published snapshot. This never blocks on a reload, and is safe to call from any thread.
+		std::shared_ptr<const ConfigSnapshot> GetSnapshot() const noexcept
+		{
+			return current.load();
+		}
+	};
+}
@@ -1,7 +1,11 @@
 #pragma once
 #include "INamedObject.hpp"
 #include "Keyword.hpp"
+#include "keywords/KeywordTable.h"
 
+#include <var.hpp>
+
+#include <algorithm>
 #include <vector>
 
 namespace alchlib2 {
@@ -15,11 +19,12 @@ namespace alchlib2 {
 		STRCONSTEXPR Effect(std::string const& name, const float magnitude, const unsigned duration, const std::vector<Keyword>& keywords = {}) : INamedObject(name), magnitude{ magnitude }, duration{ duration }, keywords{ keywords } {}
 
 		[[nodiscard]] CONSTEXPR bool IsNullEffect() const { return magnitude == -0.0f && duration == 0u; }
+		/// @brief	Gets the most significant disposition of this effect's keywords. Known keywords are looked up in the compile-time keyword table; the disposition stored with the keyword is only used for unknown ones.
 		[[nodiscard]] CONSTEXPR EKeywordDisposition GetDisposition() const
 		{
 			EKeywordDisposition val{};
 			for (const auto& kywd : keywords)
-				val |= kywd.disposition;
+				val |= keywords::GetDisposition(kywd);
 			return $c(EKeywordDisposition, GetHighestBit(val));
 		}
 		template<var::any_same_or_convertible<Keyword>... TKeywords> requires var::at_least_one<TKeywords...>
@@ -27,15 +32,14 @@ namespace alchlib2 {
 		{
 			return std::any_of(this->keywords.begin(), this->keywords.end(), [&](auto&& kywd) { return var::variadic_or(kywd == keywords...); });
 		}
-		[[nodiscard]] CONSTEXPR bool HasKeywordNamed(std::string const& name) const
+		[[nodiscard]] CONSTEXPR bool HasKeywordNamed(std::string_view const name) const
 		{
 			return std::any_of(keywords.begin(), keywords.end(), [&name](auto&& kywd) { return kywd.IsSimilarTo(name, false); });
 		}
 
-		[[nodiscard]] CONSTEXPR bool IsSimilarTo(const std::string& name, const bool requireExactMatch) const
+		[[nodiscard]] CONSTEXPR bool IsSimilarTo(std::string_view const name, const bool requireExactMatch) const
 		{
-			const auto thisNameLower{ str::tolower(this->name) }, nameLower{ str::tolower(name) };
-			return requireExactMatch ? thisNameLower == nameLower : thisNameLower.find(nameLower) != std::string::npos;
+			return ci::matches(this->name, name, requireExactMatch);
 		}
 	};
 }
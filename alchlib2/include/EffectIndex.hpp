@@ -0,0 +1,95 @@
+#pragma once
+/**
+ * @file	EffectIndex.hpp
+ * @author	radj307
+ * @brief	Inverted index from effects to the ingredients that have them.
+ */
+#include "EffectTable.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace alchlib2 {
+	/**
+	 * @brief	Maps each effect ID in an EffectTable to the indices of the ingredients that have that effect.
+	 *			The lists are stored back to back in one array, in ingredient order, with an offset table marking where each one begins.
+	 */
+	class EffectIndex {
+		/// @brief	The list for effect ID i is [offsets[i], offsets[i + 1]). Has (effect_count + 1) elements.
+		std::vector<std::uint32_t> offsets;
+		std::vector<std::uint32_t> ingredients;
+
+	public:
+		EffectIndex() = default;
+		EffectIndex(EffectTable const& table) : offsets(table.effect_count() + 1, 0)
+		{
+			const auto ids{ table.EffectIDs() };
+
+			// count the ingredients with each effect, then turn the counts into offsets
+			for (const auto id : ids)
+				if (id != EffectTable::NoEffect)
+					++offsets[id + 1];
+			for (std::size_t i{ 1 }; i < offsets.size(); ++i)
+				offsets[i] += offsets[i - 1];
+
+			ingredients.resize(offsets.back());
+			auto next{ offsets };
+			for (std::size_t slot{ 0 }; slot < ids.size(); ++slot)
+				if (const auto id{ ids[slot] }; id != EffectTable::NoEffect)
+					ingredients[next[id]++] = $c(std::uint32_t, EffectTable::ingredient_of(slot));
+		}
+
+		/// @brief	Gets the number of effects in the index.
+		std::size_t effect_count() const noexcept { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+		/**
+		 * @brief		Gets the indices of every ingredient that has the given effect.
+		 * @param id	An effect ID from the EffectTable that this index was built from.
+		 * @returns		The ingredient indices, in ascending order. An ingredient with the same effect in more than one slot appears more than once.
+		 */
+		std::span<const std::uint32_t> GetIngredientsWith(EffectTable::EffectID const id) const noexcept
+		{
+			if (id >= effect_count())
+				return {};
+			return std::span<const std::uint32_t>{ ingredients }.subspan(offsets[id], offsets[id + 1] - offsets[id]);
+		}
+
+		/**
+		 * @brief					Gets every ingredient that shares at least one effect with the given ingredient.
+		 *							This only visits the lists of the ingredient's own effects, so it costs O(partners) rather than O(registry).
+		 *							When the table is incomplete, the ingredients are scanned instead so that effects past the table's slots are included.
+		 * @param table				The EffectTable that this index was built from.
+		 * @param ingredients		The ingredients that the table was built from.
+		 * @param ingredientIndex	The index of the ingredient to find partners for.
+		 * @returns					The partners' indices in ascending order, excluding the ingredient itself.
+		 */
+		std::vector<std::size_t> FindPartners(EffectTable const& table, std::vector<Ingredient> const& ingredients, std::size_t const ingredientIndex) const
+		{
+			if (!table.is_complete()) {
+				// effects are compared by name, like get_common_effects does
+				const auto& effects{ ingredients.at(ingredientIndex).effects };
+				std::vector<std::size_t> partners;
+				for (std::size_t i{ 0 }; i < ingredients.size(); ++i) {
+					if (i != ingredientIndex && std::any_of(ingredients[i].effects.begin(), ingredients[i].effects.end(), [&effects](auto&& effect) {
+						return std::any_of(effects.begin(), effects.end(), [&effect](auto&& it) { return it.name == effect.name; });
+					}))
+						partners.emplace_back(i);
+				}
+				return partners;
+			}
+
+			std::vector<std::size_t> partners;
+			const auto ids{ table.EffectIDs() };
+			for (auto slot{ EffectTable::first_slot_of(ingredientIndex) }, last{ slot + EffectTable::SlotsPerIngredient }; slot < last; ++slot) {
+				for (const auto partner : GetIngredientsWith(ids[slot]))
+					if (partner != ingredientIndex)
+						partners.emplace_back(partner);
+			}
+			std::sort(partners.begin(), partners.end());
+			partners.erase(std::unique(partners.begin(), partners.end()), partners.end());
+			return partners;
+		}
+	};
+}
@@ -0,0 +1,220 @@
+#pragma once
+/**
+ * @file	EffectTable.hpp
+ * @author	radj307
+ * @brief	Structure-of-arrays copy of the numeric effect data in a list of ingredients, for unit-stride ranking & building loops.
+ */
+#include "Ingredient.hpp"
+#include "keywords/VanillaKeywords.h"
+
+#include <make_exception.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace alchlib2 {
+	enum class EEffectFlags : std::uint8_t {
+		None = 0,
+		/// @brief	The effect has the MagicAlchDurationBased keyword, so the alchemy formula is applied to its duration instead of its magnitude.
+		DurationBased = 1,
+		/// @brief	The effect has the MagicAlchHarmful keyword.
+		Harmful = 2,
+	};
+	$make_bitfield_operators(EEffectFlags, std::uint8_t);
+
+	/**
+	 * @brief	Stores the effect ID, magnitude, duration, disposition & flags of every effect in a list of ingredients in parallel arrays.
+	 *			Each ingredient occupies SlotsPerIngredient consecutive slots, so the effects of ingredient i are in slots [i * 4, i * 4 + 4).
+	 *			Unused slots have the effect ID NoEffect.
+	 *			Effect IDs are assigned in order of first appearance; effects with the same name share an ID.
+	 */
+	class EffectTable {
+	public:
+		using EffectID = std::uint16_t;
+		static constexpr EffectID NoEffect{ std::numeric_limits<EffectID>::max() };
+		static constexpr std::size_t SlotsPerIngredient{ 4 };
+
+	private:
+		std::vector<EffectID> effectIDs;
+		std::vector<float> magnitudes;
+		std::vector<unsigned> durations;
+		std::vector<EKeywordDisposition> dispositions;
+		std::vector<EEffectFlags> flags;
+		/// @brief	The name of each effect ID.
+		std::vector<std::string> effectNames;
+		std::unordered_map<std::string, EffectID> effectIDsByName;
+		/// @brief	false when any ingredient has more than SlotsPerIngredient effects.
+		bool complete{ true };
+
+	public:
+		EffectTable() = default;
+		EffectTable(std::vector<Ingredient> const& ingredients)
+		{
+			const auto slotCount{ ingredients.size() * SlotsPerIngredient };
+			effectIDs.resize(slotCount, NoEffect);
+			magnitudes.resize(slotCount, 0.0f);
+			durations.resize(slotCount, 0u);
+			dispositions.resize(slotCount, EKeywordDisposition::Unknown);
+			flags.resize(slotCount, EEffectFlags::None);
+
+			for (std::size_t i{ 0 }; i < ingredients.size(); ++i) {
+				const auto& effects{ ingredients[i].effects };
+				if (effects.size() > SlotsPerIngredient)
+					complete = false;
+
+				for (std::size_t j{ 0 }; j < effects.size() && j < SlotsPerIngredient; ++j) {
+					const auto& effect{ effects[j] };
+					const auto slot{ i * SlotsPerIngredient + j };
+
+					auto [it, inserted] { effectIDsByName.try_emplace(effect.name, $c(EffectID, effectNames.size())) };
+					if (inserted) {
+						if (effectNames.size() >= NoEffect)
+							throw make_exception("Too many unique effects to fit in an EffectTable! (Max ", NoEffect, ')');
+						effectNames.emplace_back(effect.name);
+					}
+
+					effectIDs[slot] = it->second;
+					magnitudes[slot] = effect.magnitude;
+					durations[slot] = effect.duration;
+					dispositions[slot] = effect.GetDisposition();
+					if (effect.HasAnyKeyword(keywords::MagicAlchDurationBased))
+						flags[slot] |= EEffectFlags::DurationBased;
+					if (effect.HasAnyKeyword(keywords::MagicAlchHarmful))
+						flags[slot] |= EEffectFlags::Harmful;
+				}
+			}
+		}
+
+	#pragma region Accessors
+		/// @brief	Gets the number of ingredients that this table was built from.
+		std::size_t ingredient_count() const noexcept { return effectIDs.size() / SlotsPerIngredient; }
+		/// @brief	Gets the total number of slots, which is ingredient_count() * SlotsPerIngredient.
+		std::size_t slot_count() const noexcept { return effectIDs.size(); }
+		/// @brief	Gets the number of unique effects.
+		std::size_t effect_count() const noexcept { return effectNames.size(); }
+		/// @brief	Checks whether every effect of every ingredient is present in the table. When false, callers must fall back to the ingredient objects.
+		bool is_complete() const noexcept { return complete; }
+
+		static constexpr std::size_t ingredient_of(std::size_t const slot) noexcept { return slot / SlotsPerIngredient; }
+		static constexpr std::size_t first_slot_of(std::size_t const ingredientIndex) noexcept { return ingredientIndex * SlotsPerIngredient; }
+
+		std::span<const EffectID> EffectIDs() const noexcept { return effectIDs; }
+		std::span<const float> Magnitudes() const noexcept { return magnitudes; }
+		std::span<const unsigned> Durations() const noexcept { return durations; }
+		std::span<const EKeywordDisposition> Dispositions() const noexcept { return dispositions; }
+		std::span<const EEffectFlags> Flags() const noexcept { return flags; }
+
+		/// @brief	Gets the name of the effect with the given ID.
+		std::string const& GetEffectName(EffectID const id) const { return effectNames.at(id); }
+		/// @brief	Gets the ID of the effect with the given (case-sensitive) name, or std::nullopt when no ingredient has it.
+		std::optional<EffectID> FindEffectID(std::string const& name) const
+		{
+			if (const auto it{ effectIDsByName.find(name) }; it != effectIDsByName.end())
+				return it->second;
+			return std::nullopt;
+		}
+	#pragma endregion Accessors
+
+	#pragma region Kernels
+		/**
+		 * @brief		Calls the given function with every slot that contains the given effect, in ingredient order.
+		 * @param id	An effect ID.
+		 * @param func	A callable with the signature void(std::size_t slot).
+		 */
+		template<typename TFunc>
+		void ForEachSlotWith(EffectID const id, TFunc&& func) const
+		{
+			for (std::size_t slot{ 0 }; slot < effectIDs.size(); ++slot)
+				if (effectIDs[slot] == id)
+					func(slot);
+		}
+
+		/**
+		 * @brief		Finds the slot with the highest magnitude for the given effect.
+		 * @param id	An effect ID.
+		 * @returns		The first slot with the highest magnitude, or std::nullopt when no ingredient has the effect.
+		 */
+		std::optional<std::size_t> FindStrongest(EffectID const id) const noexcept
+		{
+			std::size_t best{ effectIDs.size() };
+			float bestMagnitude{ -std::numeric_limits<float>::infinity() };
+			for (std::size_t slot{ 0 }; slot < effectIDs.size(); ++slot) {
+				if (effectIDs[slot] == id && (best == effectIDs.size() || magnitudes[slot] > bestMagnitude)) {
+					best = slot;
+					bestMagnitude = magnitudes[slot];
+				}
+			}
+			if (best == effectIDs.size())
+				return std::nullopt;
+			return best;
+		}
+
+		/**
+		 * @brief				Gets the common effects of the given ingredients with the same result as get_common_effects, without touching the ingredient objects until the result is built.
+		 * @param ingredients	The ingredients that this table was built from.
+		 * @param indices		The indices of the ingredients to combine.
+		 * @returns				The effects that appear more than once among the given ingredients, in the order get_common_effects returns them.
+		 */
+		std::vector<Effect> GetCommonEffects(std::vector<Ingredient> const& ingredients, std::span<const std::size_t> const indices) const
+		{
+			struct Entry {
+				EffectID id;
+				/// @brief	The slot of the first occurrence of the effect.
+				std::size_t first;
+				/// @brief	The slot that the common effect is copied from, or NoSlot when the effect has only appeared once.
+				std::size_t chosen;
+				float magnitude;
+				unsigned duration;
+			};
+			constexpr std::size_t NoSlot{ std::numeric_limits<std::size_t>::max() };
+
+			std::vector<Entry> entries;
+			entries.reserve(indices.size() * SlotsPerIngredient);
+			std::vector<std::size_t> order; //< the entries that became common, in the order they did
+			order.reserve(SlotsPerIngredient * 2);
+
+			for (const auto index : indices) {
+				for (auto slot{ first_slot_of(index) }, last{ slot + SlotsPerIngredient }; slot < last; ++slot) {
+					const auto id{ effectIDs[slot] };
+					if (id == NoEffect)
+						continue;
+
+					auto it{ std::find_if(entries.begin(), entries.end(), [id](Entry const& e) { return e.id == id; }) };
+					if (it == entries.end()) {
+						entries.emplace_back(Entry{ id, slot, NoSlot, magnitudes[slot], durations[slot] });
+					}
+					else if (it->chosen == NoSlot) {
+						// the first time an effect repeats, it is copied from whichever occurrence is stronger
+						const auto chosen{ magnitudes[slot] < magnitudes[it->first] ? it->first : slot };
+						it->chosen = chosen;
+						it->magnitude = magnitudes[chosen];
+						it->duration = durations[chosen];
+						order.emplace_back($c(std::size_t, std::distance(entries.begin(), it)));
+					}
+					else {
+						if (magnitudes[slot] > it->magnitude)
+							it->magnitude = magnitudes[slot];
+						if (durations[slot] > it->duration)
+							it->duration = durations[slot];
+					}
+				}
+			}
+
+			std::vector<Effect> common;
+			common.reserve(order.size());
+			for (const auto i : order) {
+				const auto& entry{ entries[i] };
+				auto& effect{ common.emplace_back(ingredients[ingredient_of(entry.chosen)].effects[entry.chosen % SlotsPerIngredient]) };
+				effect.magnitude = entry.magnitude;
+				effect.duration = entry.duration;
+			}
+			return common;
+		}
+	#pragma endregion Kernels
+	};
+}
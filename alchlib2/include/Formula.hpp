@@ -1,7 +1,10 @@
 #pragma once
 #include "GameSetting.hpp"
+#include "FormulaExpression.hpp"
 #include "PerkBase.hpp"
 
+#include <array>
+
 namespace alchlib2 {
 	template<typename TReturn, typename... TArgs>
 	struct FormulaBase {
@@ -14,17 +17,49 @@ namespace alchlib2 {
 
 	struct AlchemyCoreFormula : FormulaBase<float, float> {
 		AlchemyCoreFormula(const AlchemyCoreGameSettings& coreGameSettings) : coreGameSettings{ coreGameSettings } {}
+		/**
+		 * @brief					Creates a formula that uses a compiled formula expression instead of the vanilla formula.
+		 * @param coreGameSettings	The game settings that the program was compiled for.
+		 * @param program			The compiled formula, which replaces the vanilla formula in GetResult.
+		 */
+		AlchemyCoreFormula(const AlchemyCoreGameSettings& coreGameSettings, FormulaProgram&& program) : coreGameSettings{ coreGameSettings }, program{ std::move(program) } {}
 
 		const AlchemyCoreGameSettings& coreGameSettings;
+		/// @brief	When not empty, this is evaluated instead of the vanilla formula.
+		FormulaProgram program;
+
+		/// @brief	The number of factors that the base value is multiplied by.
+		static constexpr std::size_t FactorCount{ 5 };
+
+		/**
+		 * @brief					Gets the factors that the base value is multiplied by, in the order that they're applied.
+		 *							Multiplying a base value by each of these in order produces the same result as GetResult, so they can be
+		 *							computed once & reused for many base values.
+		 * @param coreGameSettings	An AlchemyCoreGameSettings instance to use.
+		 */
+		static std::array<float, FactorCount> GetFactors(const AlchemyCoreGameSettings& coreGameSettings)
+		{
+			return {
+				coreGameSettings.fAlchemyIngredientInitMult,
+				(1.0f + coreGameSettings.fAlchemyAV / 200.0f),
+				(1.0f + (coreGameSettings.fAlchemySkillFactor - 1.0f)),
+				(coreGameSettings.fAlchemyAV / 100.0f),
+				(1.0f + coreGameSettings.fAlchemyMod / 100.0f),
+			};
+		}
 
 		float GetResult(const float base_val) const override
 		{
+			if (!program.empty())
+				return program(base_val);
+
+			const auto factors{ GetFactors(coreGameSettings) };
 			return base_val
-				* coreGameSettings.fAlchemyIngredientInitMult
-				* (1.0f + coreGameSettings.fAlchemyAV / 200.0f)
-				* (1.0f + (coreGameSettings.fAlchemySkillFactor - 1.0f))
-				* (coreGameSettings.fAlchemyAV / 100.0f)
-				* (1.0f + coreGameSettings.fAlchemyMod / 100.0f);
+				* factors[0]
+				* factors[1]
+				* factors[2]
+				* factors[3]
+				* factors[4];
 		}
 
 		/**
@@ -0,0 +1,424 @@
+#pragma once
+/**
+ * @file	FormulaExpression.hpp
+ * @author	radj307
+ * @brief	User-defined alchemy formulas, which are parsed once & compiled into flat programs with constant subexpressions folded.
+ */
+#include "GameSetting.hpp"
+
+#include <sysarch.h>
+#include <make_exception.hpp>
+#include <fileio.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace alchlib2 {
+	/// @brief	The vanilla alchemy formula. Compiling this produces the same results as AlchemyCoreFormula::GetResult, down to the last bit.
+	inline constexpr std::string_view DefaultFormulaExpression{ "base * fAlchemyIngredientInitMult * (1 + fAlchemyAV / 200) * (1 + (fAlchemySkillFactor - 1)) * (fAlchemyAV / 100) * (1 + fAlchemyMod / 100)" };
+
+	enum class EFormulaOp : std::uint8_t {
+		/// @brief	Pushes a constant.
+		Constant,
+		/// @brief	Pushes the base value.
+		Base,
+		Add,
+		Subtract,
+		Multiply,
+		Divide,
+		Min,
+		Max,
+		Pow,
+		Negate,
+		/// @brief	Adds a constant to the top of the stack.
+		AddConstant,
+		/// @brief	Subtracts a constant from the top of the stack.
+		SubtractConstant,
+		/// @brief	Multiplies the top of the stack by a constant.
+		MultiplyConstant,
+		/// @brief	Divides the top of the stack by a constant.
+		DivideConstant,
+	};
+
+	/// @brief	Applies a binary operator. This is shared by constant folding & evaluation, so that both produce the same results.
+	inline CONSTEXPR float apply_formula_op(EFormulaOp const op, float const l, float const r) noexcept
+	{
+		switch (op) {
+		case EFormulaOp::Add:
+		case EFormulaOp::AddConstant:
+			return l + r;
+		case EFormulaOp::Subtract:
+		case EFormulaOp::SubtractConstant:
+			return l - r;
+		case EFormulaOp::Multiply:
+		case EFormulaOp::MultiplyConstant:
+			return l * r;
+		case EFormulaOp::Divide:
+		case EFormulaOp::DivideConstant:
+			return l / r;
+		case EFormulaOp::Min:
+			return std::min(l, r);
+		case EFormulaOp::Max:
+			return std::max(l, r);
+		case EFormulaOp::Pow:
+			return std::pow(l, r);
+		default:
+			return 0.0f;
+		}
+	}
+
+	/**
+	 * @brief	A compiled formula, which is a flat list of stack machine instructions with a single input: the base value.
+	 *			Every subexpression that doesn't depend on the base value has already been folded into a constant.
+	 */
+	class FormulaProgram {
+	public:
+		/// @brief	The maximum stack depth that a program may use.
+		static constexpr std::size_t MaxDepth{ 32 };
+
+		struct Instruction {
+			EFormulaOp op;
+			/// @brief	The constant operand of Constant & *Constant instructions.
+			float value;
+		};
+
+	private:
+		std::vector<Instruction> code;
+
+	public:
+		/// @brief	Creates an empty program, which doesn't compute anything.
+		FormulaProgram() = default;
+		FormulaProgram(std::vector<Instruction>&& code) : code{ std::move(code) } {}
+
+		std::vector<Instruction> const& GetInstructions() const noexcept { return code; }
+		/// @brief	Checks whether this program has no instructions. Compiled programs are never empty.
+		bool empty() const noexcept { return code.empty(); }
+
+		/// @brief	Evaluates the formula with the given base value.
+		float operator()(float const base) const noexcept
+		{
+			float stack[MaxDepth];
+			std::size_t top{ 0 };
+			for (const auto& [op, value] : code) {
+				switch (op) {
+				case EFormulaOp::Constant:
+					stack[top++] = value;
+					break;
+				case EFormulaOp::Base:
+					stack[top++] = base;
+					break;
+				case EFormulaOp::Negate:
+					stack[top - 1] = -stack[top - 1];
+					break;
+				case EFormulaOp::AddConstant:
+				case EFormulaOp::SubtractConstant:
+				case EFormulaOp::MultiplyConstant:
+				case EFormulaOp::DivideConstant:
+					stack[top - 1] = apply_formula_op(op, stack[top - 1], value);
+					break;
+				default:
+					--top;
+					stack[top - 1] = apply_formula_op(op, stack[top - 1], stack[top]);
+					break;
+				}
+			}
+			return stack[0];
+		}
+	};
+
+	/**
+	 * @brief	A parsed formula expression.
+	 *
+	 *			Expressions support numbers, the + - * / operators, unary minus, parentheses, and the functions min(a, b), max(a, b)
+	 *			& pow(a, b). Identifiers refer to the base value ("base"), to the core game settings by their editor IDs, or to any
+	 *			term that is provided when the expression is compiled. All arithmetic is done with floats, in the order written.
+	 */
+	class FormulaExpression {
+		struct Node {
+			EFormulaOp op;
+			float value{ 0.0f };
+			/// @brief	The name of an identifier. Only used by Constant nodes that haven't been resolved yet.
+			std::string identifier;
+			std::size_t lhs{ 0 }, rhs{ 0 };
+		};
+
+		std::string source;
+		std::vector<Node> nodes;
+		std::size_t root{ 0 };
+
+	#pragma region Parser
+		struct Parser {
+			std::string_view str;
+			std::vector<Node>& nodes;
+			std::size_t pos{ 0 };
+
+			[[noreturn]] void fail(std::string_view const message) const
+			{
+				throw make_exception("Invalid formula \"", str, "\": ", message, " at position ", pos, '!');
+			}
+
+			char peek()
+			{
+				while (pos < str.size() && std::isspace($c(unsigned char, str[pos])))
+					++pos;
+				return pos < str.size() ? str[pos] : '\0';
+			}
+			bool accept(char const c)
+			{
+				if (peek() != c)
+					return false;
+				++pos;
+				return true;
+			}
+			void expect(char const c)
+			{
+				if (!accept(c))
+					fail(std::string{ "expected '" } + c + '\'');
+			}
+
+			std::size_t add(Node&& node)
+			{
+				nodes.emplace_back(std::move(node));
+				return nodes.size() - 1;
+			}
+			std::size_t add_binary(EFormulaOp const op, std::size_t const lhs, std::size_t const rhs)
+			{
+				return add(Node{ op, 0.0f, {}, lhs, rhs });
+			}
+
+			std::size_t parse_expression()
+			{
+				auto lhs{ parse_term() };
+				for (;;) {
+					if (accept('+')) lhs = add_binary(EFormulaOp::Add, lhs, parse_term());
+					else if (accept('-')) lhs = add_binary(EFormulaOp::Subtract, lhs, parse_term());
+					else return lhs;
+				}
+			}
+			std::size_t parse_term()
+			{
+				auto lhs{ parse_unary() };
+				for (;;) {
+					if (accept('*')) lhs = add_binary(EFormulaOp::Multiply, lhs, parse_unary());
+					else if (accept('/')) lhs = add_binary(EFormulaOp::Divide, lhs, parse_unary());
+					else return lhs;
+				}
+			}
+			std::size_t parse_unary()
+			{
+				if (accept('-')) {
+					const auto operand{ parse_unary() };
+					return add(Node{ EFormulaOp::Negate, 0.0f, {}, operand, 0 });
+				}
+				if (accept('+'))
+					return parse_unary();
+				return parse_primary();
+			}
+			std::size_t parse_primary()
+			{
+				const char c{ peek() };
+				if (accept('(')) {
+					const auto inner{ parse_expression() };
+					expect(')');
+					return inner;
+				}
+				if (std::isdigit($c(unsigned char, c)) || c == '.') {
+					float value{};
+					const auto [end, ec] { std::from_chars(str.data() + pos, str.data() + str.size(), value) };
+					if (ec != std::errc{})
+						fail("invalid number");
+					pos = $c(std::size_t, end - str.data());
+					return add(Node{ EFormulaOp::Constant, value, {} });
+				}
+				if (std::isalpha($c(unsigned char, c)) || c == '_') {
+					const auto begin{ pos };
+					while (pos < str.size() && (std::isalnum($c(unsigned char, str[pos])) || str[pos] == '_'))
+						++pos;
+					const std::string_view name{ str.substr(begin, pos - begin) };
+
+					if (accept('(')) {
+						EFormulaOp op;
+						if (name == "min") op = EFormulaOp::Min;
+						else if (name == "max") op = EFormulaOp::Max;
+						else if (name == "pow") op = EFormulaOp::Pow;
+						else fail("unknown function '" + std::string{ name } + '\'');
+
+						const auto lhs{ parse_expression() };
+						expect(',');
+						const auto rhs{ parse_expression() };
+						expect(')');
+						return add_binary(op, lhs, rhs);
+					}
+					if (name == "base")
+						return add(Node{ EFormulaOp::Base, 0.0f, {} });
+					return add(Node{ EFormulaOp::Constant, 0.0f, std::string{ name } });
+				}
+				fail(c == '\0' ? "unexpected end of expression" : std::string{ "unexpected character '" } + c + '\'');
+			}
+		};
+	#pragma endregion Parser
+
+	#pragma region Compiler
+		/// @brief	Replaces identifiers with their values, and folds every node that doesn't depend on the base value. Returns true when the node is constant.
+		bool fold(std::vector<Node>& folded, std::size_t const index, AlchemyCoreGameSettings const& coreGameSettings, std::map<std::string, float, std::less<>> const& terms) const
+		{
+			auto& node{ folded[index] };
+			switch (node.op) {
+			case EFormulaOp::Base:
+				return false;
+			case EFormulaOp::Constant:
+				if (!node.identifier.empty()) {
+					if (const auto it{ terms.find(node.identifier) }; it != terms.end())
+						node.value = it->second;
+					else if (node.identifier == coreGameSettings.fAlchemyIngredientInitMult.name)
+						node.value = coreGameSettings.fAlchemyIngredientInitMult;
+					else if (node.identifier == coreGameSettings.fAlchemySkillFactor.name)
+						node.value = coreGameSettings.fAlchemySkillFactor;
+					else if (node.identifier == coreGameSettings.fAlchemyAV.name)
+						node.value = coreGameSettings.fAlchemyAV;
+					else if (node.identifier == coreGameSettings.fAlchemyMod.name)
+						node.value = coreGameSettings.fAlchemyMod;
+					else throw make_exception("Invalid formula \"", source, "\": unknown identifier '", node.identifier, "'!");
+				}
+				return true;
+			case EFormulaOp::Negate:
+				if (!fold(folded, node.lhs, coreGameSettings, terms))
+					return false;
+				node = Node{ EFormulaOp::Constant, -folded[node.lhs].value, {} };
+				return true;
+			default: {
+				const bool lhsConstant{ fold(folded, node.lhs, coreGameSettings, terms) };
+				const bool rhsConstant{ fold(folded, node.rhs, coreGameSettings, terms) };
+				if (!lhsConstant || !rhsConstant)
+					return false;
+				node = Node{ EFormulaOp::Constant, apply_formula_op(node.op, folded[node.lhs].value, folded[node.rhs].value), {} };
+				return true;
+			}
+			}
+		}
+		/// @brief	Appends the instructions for a folded node to the program, and returns the stack depth that they need.
+		static std::size_t emit(std::vector<Node> const& folded, std::size_t const index, std::vector<FormulaProgram::Instruction>& code)
+		{
+			const auto& node{ folded[index] };
+			switch (node.op) {
+			case EFormulaOp::Constant:
+			case EFormulaOp::Base:
+				code.emplace_back(FormulaProgram::Instruction{ node.op, node.value });
+				return 1;
+			case EFormulaOp::Negate: {
+				const auto depth{ emit(folded, node.lhs, code) };
+				code.emplace_back(FormulaProgram::Instruction{ node.op, 0.0f });
+				return depth;
+			}
+			default: {
+				const auto& lhs{ folded[node.lhs] }, & rhs{ folded[node.rhs] };
+				const auto with_constant{ [&node]() -> std::optional<EFormulaOp> {
+					switch (node.op) {
+					case EFormulaOp::Add: return EFormulaOp::AddConstant;
+					case EFormulaOp::Subtract: return EFormulaOp::SubtractConstant;
+					case EFormulaOp::Multiply: return EFormulaOp::MultiplyConstant;
+					case EFormulaOp::Divide: return EFormulaOp::DivideConstant;
+					default: return std::nullopt;
+					}
+				}() };
+
+				if (with_constant.has_value() && rhs.op == EFormulaOp::Constant) {
+					const auto depth{ emit(folded, node.lhs, code) };
+					code.emplace_back(FormulaProgram::Instruction{ with_constant.value(), rhs.value });
+					return depth;
+				}
+				// addition & multiplication are commutative for floats, so a constant on the left can be applied the same way
+				if ((node.op == EFormulaOp::Add || node.op == EFormulaOp::Multiply) && lhs.op == EFormulaOp::Constant) {
+					const auto depth{ emit(folded, node.rhs, code) };
+					code.emplace_back(FormulaProgram::Instruction{ with_constant.value(), lhs.value });
+					return depth;
+				}
+
+				const auto lhsDepth{ emit(folded, node.lhs, code) };
+				const auto rhsDepth{ emit(folded, node.rhs, code) };
+				code.emplace_back(FormulaProgram::Instruction{ node.op, 0.0f });
+				return std::max(lhsDepth, rhsDepth + 1);
+			}
+			}
+		}
+	#pragma endregion Compiler
+
+	public:
+		/**
+		 * @brief			Parses a formula expression.
+		 * @param source	The expression to parse.
+		 * @throws			ex::except when the expression is invalid.
+		 */
+		FormulaExpression(std::string const& source) : source{ source }
+		{
+			Parser parser{ this->source, nodes };
+			root = parser.parse_expression();
+			if (parser.peek() != '\0')
+				parser.fail("unexpected character '" + std::string(1, parser.peek()) + '\'');
+		}
+
+		std::string const& GetSource() const noexcept { return source; }
+
+		/**
+		 * @brief					Compiles the expression for the given game settings & terms, which become constants in the program.
+		 * @param coreGameSettings	The game settings that identifiers may refer to.
+		 * @param terms				Additional named values that identifiers may refer to. These take priority over game settings with the same name.
+		 * @throws					ex::except when the expression refers to an unknown identifier, or is too deeply nested.
+		 */
+		FormulaProgram Compile(AlchemyCoreGameSettings const& coreGameSettings, std::map<std::string, float, std::less<>> const& terms = {}) const
+		{
+			auto folded{ nodes };
+			fold(folded, root, coreGameSettings, terms);
+
+			std::vector<FormulaProgram::Instruction> code;
+			if (emit(folded, root, code) > FormulaProgram::MaxDepth)
+				throw make_exception("Invalid formula \"", source, "\": the expression is nested too deeply! (Max depth ", FormulaProgram::MaxDepth, ')');
+			return FormulaProgram{ std::move(code) };
+		}
+	};
+
+	/// @brief	A formula config, which contains a formula expression & the values of any terms it uses besides the game settings.
+	struct FormulaConfig {
+		std::string expression{ DefaultFormulaExpression };
+		std::map<std::string, float, std::less<>> terms;
+
+		friend void to_json(nlohmann::json& j, const FormulaConfig& config)
+		{
+			j = nlohmann::json{ { "expression", config.expression }, { "terms", config.terms } };
+		}
+		friend void from_json(const nlohmann::json& j, FormulaConfig& config)
+		{
+			config.expression = j.value("expression", std::string{ DefaultFormulaExpression });
+			config.terms = j.value("terms", std::map<std::string, float, std::less<>>{});
+		}
+
+		/// @brief	Parses the expression & compiles it for the given game settings.
+		FormulaProgram Compile(AlchemyCoreGameSettings const& coreGameSettings) const
+		{
+			return FormulaExpression{ expression }.Compile(coreGameSettings, terms);
+		}
+
+		[[nodiscard]] static FormulaConfig ReadFrom(const std::filesystem::path& path)
+		{
+			nlohmann::json j;
+			file::read(path) >> j;
+			return j.get<FormulaConfig>();
+		}
+		static bool WriteTo(const std::filesystem::path& path, const FormulaConfig& config)
+		{
+			std::stringstream ss;
+			ss << nlohmann::json(config).dump(1, '\t');
+			return file::write_to(path, std::move(ss), false);
+		}
+	};
+}
@@ -1,6 +1,4 @@
 #pragma once
-#include "INamedObject.hpp"
-
 #include <sysarch.h>
 #include <var.hpp>
 #include <make_exception.hpp>
@@ -8,6 +6,8 @@
 
 #include <nlohmann/json.hpp>
 
+#include <string_view>
+#include <type_traits>
 #include <variant>
 
 namespace alchlib2 {
@@ -25,7 +25,7 @@ namespace alchlib2 {
 	};
 
 	template<ValidGameSettingValueType T>
-	inline GameSettingType GetGameSettingType()
+	constexpr GameSettingType GetGameSettingType()
 	{
 		if constexpr (std::same_as<T, std::string>)
 			return GameSettingType::String;
@@ -38,50 +38,76 @@ namespace alchlib2 {
 		return GameSettingType::Null;
 	}
 
-	struct GameSettingBase : INamedObject {
-		STRCONSTEXPR GameSettingBase(GameSettingType const& type) : type{ type } {}
-		STRCONSTEXPR GameSettingBase(const std::string& name, GameSettingType const& type) : INamedObject(name), type{ type }
+	/**
+	 * @brief		A string literal that can be used as a template argument, so that the name of a game setting is part of its type.
+	 * @tparam N	The length of the string, including the null terminator.
+	 */
+	template<std::size_t N>
+	struct GameSettingName {
+		char chars[N];
+
+		consteval GameSettingName(const char(&str)[N])
 		{
-			if (!validate_gmst_naming_scheme(name)) {
-				throw make_exception("Unexpected GMST editor ID '", name, "'; expected a name starting with 'f', 's', 'i', or 'b'!");
-			}
+			for (std::size_t i{ 0 }; i < N; ++i)
+				chars[i] = str[i];
 		}
 
-		CONSTEXPR GameSettingType GetType() const noexcept { return type; }
-
-	private:
-		GameSettingType type;
+		constexpr std::string_view view() const noexcept { return { chars, N - 1 }; }
 
-		STRCONSTEXPR static bool validate_gmst_naming_scheme(const std::string& name)
+		/// @brief	Checks that the name follows the GMST editor ID naming scheme, where the first character is 'f', 's', 'i', or 'b'.
+		constexpr bool is_valid() const noexcept
 		{
-			if (name.empty()) return false;
+			if (N <= 1) return false;
 
-			const auto& fst{ name.at(0) };
+			const auto& fst{ chars[0] };
 			//       float    ||   string   ||  integral  ||   boolean
 			return fst == 'f' || fst == 's' || fst == 'i' || fst == 'b';
 		}
 	};
 
-	template<ValidGameSettingValueType T>
-	struct GameSetting : GameSettingBase {
-		STRCONSTEXPR GameSetting() : GameSettingBase(GetGameSettingType<T>()) {}
-		STRCONSTEXPR GameSetting(const std::string& name, const T& value) : GameSettingBase(name, GetGameSettingType<T>()), value{ value } {}
+	/**
+	 * @brief		A game setting whose name is a compile-time constant.
+	 *				Only the value is stored in each instance, so settings with trivially copyable values are themselves trivially copyable.
+	 * @tparam Name	The GMST editor ID of the setting.
+	 * @tparam T	The type of the setting's value.
+	 */
+	template<GameSettingName Name, ValidGameSettingValueType T>
+	struct GameSetting {
+		static_assert(Name.is_valid(), "Unexpected GMST editor ID; expected a name starting with 'f', 's', 'i', or 'b'!");
+
+		static constexpr std::string_view name{ Name.view() };
+		static constexpr GameSettingType type{ GetGameSettingType<T>() };
+
+		T value{};
 
-		T value;
+		constexpr GameSetting() = default;
+		constexpr GameSetting(const T& value) : value{ value } {}
+
+		static constexpr GameSettingType GetType() noexcept { return type; }
 
 		CONSTEXPR operator T& () noexcept { return value; }
 		CONSTEXPR operator T() const noexcept { return value; }
 
-		NLOHMANN_DEFINE_TYPE_INTRUSIVE(GameSetting, name, value);
+		friend void to_json(nlohmann::json& j, const GameSetting& gameSetting)
+		{
+			j = nlohmann::json{ { "name", name }, { "value", gameSetting.value } };
+		}
+		friend void from_json(const nlohmann::json& j, GameSetting& gameSetting)
+		{
+			if (const auto it{ j.find("name") }; it != j.end() && it->get<std::string>() != name)
+				throw make_exception("Unexpected GMST editor ID '", it->get<std::string>(), "'; expected '", name, "'!");
+			j.at("value").get_to(gameSetting.value);
+		}
 	};
 
+	/// @brief	The game settings used by the core alchemy formula. This is a plain 16-byte value.
 	struct AlchemyCoreGameSettings {
-		GameSetting<float> fAlchemyIngredientInitMult{ "fAlchemyIngredientInitMult", 3.0f };
-		GameSetting<float> fAlchemySkillFactor{ "fAlchemySkillFactor", 3.0f };
-		GameSetting<float> fAlchemyAV{ "fAlchemyAV", 15.0f };
-		GameSetting<float> fAlchemyMod{ "fAlchemyMod", 0.0f };
+		GameSetting<"fAlchemyIngredientInitMult", float> fAlchemyIngredientInitMult{ 3.0f };
+		GameSetting<"fAlchemySkillFactor", float> fAlchemySkillFactor{ 3.0f };
+		GameSetting<"fAlchemyAV", float> fAlchemyAV{ 15.0f };
+		GameSetting<"fAlchemyMod", float> fAlchemyMod{ 0.0f };
 
-		STRCONSTEXPR AlchemyCoreGameSettings() = default;
+		constexpr AlchemyCoreGameSettings() = default;
 
 		NLOHMANN_DEFINE_TYPE_INTRUSIVE(AlchemyCoreGameSettings,
 									   fAlchemyIngredientInitMult,
@@ -98,8 +124,10 @@ namespace alchlib2 {
 		static bool WriteTo(const std::filesystem::path& path, const AlchemyCoreGameSettings& coreGameSettings)
 		{
 			std::stringstream ss;
-			ss << nlohmann::json{ coreGameSettings };
+			ss << nlohmann::json(coreGameSettings);
 			return file::write_to(path, std::move(ss), false);
 		}
 	};
+	static_assert(sizeof(AlchemyCoreGameSettings) == 4 * sizeof(float));
+	static_assert(std::is_trivially_copyable_v<AlchemyCoreGameSettings>);
 }
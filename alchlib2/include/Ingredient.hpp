@@ -12,27 +12,23 @@ namespace alchlib2 {
 		STRCONSTEXPR Ingredient(std::string const& name, const std::vector<Effect>& effects = {}) : INamedObject(name), effects{ effects } {}
 
 	#pragma region IsSimilarTo
-		[[nodiscard]] CONSTEXPR bool IsSimilarTo(std::string name, const bool requireExactMatch) const
+		[[nodiscard]] CONSTEXPR bool IsSimilarTo(std::string_view const name, const bool requireExactMatch) const
 		{
-			name = str::tolower(name);
-			const auto thisNameLower{ str::tolower(this->name) };
-			return requireExactMatch ? name == thisNameLower : thisNameLower.find(name) != std::string::npos;
+			return ci::matches(this->name, name, requireExactMatch);
 		}
 
-		[[nodiscard]] CONSTEXPR bool AnyEffectIsSimilarTo(std::string name, const bool requireExactMatch) const
+		[[nodiscard]] CONSTEXPR bool AnyEffectIsSimilarTo(std::string_view const name, const bool requireExactMatch) const
 		{
-			name = str::tolower(name);
 			return std::any_of(effects.begin(), effects.end(), [&name, &requireExactMatch](auto&& effect) {
-				return requireExactMatch ? str::tolower(effect.name) == name : effect.IsSimilarTo(name, requireExactMatch);
+				return effect.IsSimilarTo(name, requireExactMatch);
 			});
 		}
 
-		[[nodiscard]] CONSTEXPR bool AnyEffectKeywordIsSimilarTo(std::string name, const bool requireExactMatch) const
+		[[nodiscard]] CONSTEXPR bool AnyEffectKeywordIsSimilarTo(std::string_view const name, const bool requireExactMatch) const
 		{
-			name = str::tolower(name);
 			return std::any_of(effects.begin(), effects.end(), [&name, &requireExactMatch](auto&& effect) -> bool {
 				return std::any_of(effect.keywords.begin(), effect.keywords.end(), [&name, &requireExactMatch](auto&& keyword) -> bool {
-					return requireExactMatch ? str::tolower(keyword.name) == name : keyword.IsSimilarTo(name, requireExactMatch);
+					return requireExactMatch ? ci::equals(keyword.name, name) : keyword.IsSimilarTo(name, requireExactMatch);
 				});
 			});
 		}
@@ -40,7 +36,7 @@ namespace alchlib2 {
 
 		CONSTEXPR auto operator<=>(const Ingredient& o) const noexcept
 		{
-			return str::tolower(name).compare(str::tolower(o.name));
+			return ci::compare(name, o.name);
 		}
 
 		[[nodiscard]] Ingredient MaskEffects(const std::function<bool(Effect)>& pred)
@@ -0,0 +1,109 @@
+#pragma once
+/**
+ * @file	IngredientStream.hpp
+ * @author	radj307
+ * @brief	Lazily-evaluated query results that yield each matching ingredient as soon as it is found.
+ */
+#include "Ingredient.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace alchlib2 {
+	/**
+	 * @brief				A pull-based view of the ingredients in a list that satisfy a predicate.
+	 *						Nothing is evaluated until the stream is iterated, and each increment only scans as far as the next match,
+	 *						so the first result is available without scanning the whole list or copying any ingredients.
+	 *
+	 *						The stream refers to the list that it was created from, which must outlive it and must not be modified while it is in use.
+	 * @tparam TPredicate	A callable with the signature bool(Ingredient const&).
+	 */
+	template<typename TPredicate>
+	class IngredientStream {
+		std::vector<Ingredient> const* ingredients;
+		TPredicate predicate;
+
+	public:
+		class iterator {
+			IngredientStream const* stream{ nullptr };
+			std::size_t i{ 0 };
+
+			/// @brief	Moves to the first match at or after the current position.
+			void seek()
+			{
+				const auto& list{ *stream->ingredients };
+				while (i < list.size() && !stream->predicate(list[i]))
+					++i;
+			}
+
+		public:
+			using iterator_concept = std::input_iterator_tag;
+			using iterator_category = std::input_iterator_tag;
+			using value_type = Ingredient;
+			using difference_type = std::ptrdiff_t;
+			using reference = Ingredient const&;
+			using pointer = Ingredient const*;
+
+			iterator() = default;
+			iterator(IngredientStream const* stream) : stream{ stream } { seek(); }
+
+			reference operator*() const { return (*stream->ingredients)[i]; }
+			pointer operator->() const { return &(*stream->ingredients)[i]; }
+			/// @brief	Gets the index of the current ingredient in the list that the stream was created from.
+			std::size_t index() const noexcept { return i; }
+
+			iterator& operator++()
+			{
+				++i;
+				seek();
+				return *this;
+			}
+			void operator++(int) { ++*this; }
+
+			bool operator==(std::default_sentinel_t) const noexcept
+			{
+				return i >= stream->ingredients->size();
+			}
+		};
+
+		IngredientStream(std::vector<Ingredient> const& ingredients, TPredicate predicate) : ingredients{ &ingredients }, predicate{ std::move(predicate) } {}
+
+		/// @brief	Starts a pass over the matches. Each call to begin() starts again from the beginning of the list.
+		iterator begin() const { return iterator{ this }; }
+		std::default_sentinel_t end() const noexcept { return {}; }
+	};
+
+	/**
+	 * @brief	Predicate that matches ingredients with a name matching a search term, using the same rules as Registry::copy_inclusive_filter.
+	 *			The names are compared directly, so no lookup structures need to be built before the first match can be returned.
+	 */
+	struct NameFilter {
+		std::string search_term;
+		bool requireExactMatch;
+		bool searchIngredients;
+		bool searchEffects;
+		bool searchKeywords;
+
+		bool operator()(Ingredient const& ingredient) const
+		{
+			if (search_term.find('\0') != std::string::npos) //< names never contain null characters
+				return false;
+			if (searchIngredients && ingredient.IsSimilarTo(search_term, requireExactMatch))
+				return true;
+			if (searchEffects && ingredient.AnyEffectIsSimilarTo(search_term, requireExactMatch))
+				return true;
+			if (searchKeywords) {
+				for (const auto& effect : ingredient.effects) {
+					for (const auto& keyword : effect.keywords) {
+						if (ci::matches(keyword.name, search_term, requireExactMatch) || (!requireExactMatch && ci::contains(keyword.formID, search_term)))
+							return true;
+					}
+				}
+			}
+			return false;
+		}
+	};
+}
@@ -1,13 +1,56 @@
 #pragma once
 #include "INamedObject.hpp"
 #include "EKeywordDisposition.h"
-
-#include <strconv.hpp>
+#include "CaseInsensitive.hpp"
 
 #include <compare>
+#include <cstdint>
 #include <map>
+#include <optional>
+#include <string_view>
 
 namespace alchlib2 {
+	/**
+	 * @brief			Parses a hexadecimal form ID string, such as "0F8A4E", without allocating.
+	 * @param formID	A form ID string. An optional "0x" prefix is allowed.
+	 * @returns			The numeric form ID when successful; otherwise std::nullopt.
+	 */
+	constexpr std::optional<std::uint32_t> ParseFormID(std::string_view formID) noexcept
+	{
+		if (formID.size() > 2 && formID[0] == '0' && (formID[1] == 'x' || formID[1] == 'X'))
+			formID.remove_prefix(2);
+		if (formID.empty() || formID.size() > 8)
+			return std::nullopt;
+
+		std::uint32_t value{ 0 };
+		for (const char c : formID) {
+			value <<= 4;
+			if (c >= '0' && c <= '9')
+				value |= $c(std::uint32_t, c - '0');
+			else if (c >= 'a' && c <= 'f')
+				value |= $c(std::uint32_t, c - 'a' + 10);
+			else if (c >= 'A' && c <= 'F')
+				value |= $c(std::uint32_t, c - 'A' + 10);
+			else return std::nullopt;
+		}
+		return value;
+	}
+	/**
+	 * @brief			Converts a numeric form ID to the 6-digit uppercase hexadecimal string format used by the registry.
+	 * @param formID	A numeric form ID.
+	 * @returns			The form ID as a string. IDs larger than 0xFFFFFF use as many digits as necessary.
+	 */
+	inline STRCONSTEXPR std::string FormIDToString(std::uint32_t formID)
+	{
+		constexpr char digits[]{ "0123456789ABCDEF" };
+		std::string s;
+		do {
+			s.insert(s.begin(), digits[formID & 0xF]);
+			formID >>= 4;
+		} while (formID != 0 || s.size() < 6);
+		return s;
+	}
+
 	struct Keyword : INamedObject {
 		std::string formID;
 		EKeywordDisposition disposition;
@@ -15,34 +58,56 @@ namespace alchlib2 {
 		STRCONSTEXPR Keyword() {}
 		STRCONSTEXPR Keyword(std::string const& name, std::string const& formID, EKeywordDisposition const& disposition = EKeywordDisposition::Unknown) : INamedObject(name), formID{ formID }, disposition{ disposition } {}
 
-		friend STRCONSTEXPR bool operator==(Keyword const& l, Keyword const& r) noexcept
+		friend CONSTEXPR bool operator==(Keyword const& l, Keyword const& r) noexcept
 		{
-			return str::tolower(l.name) == str::tolower(r.name) && str::tolower(l.formID) == str::tolower(r.formID);
+			return ci::equals(l.name, r.name) && ci::equals(l.formID, r.formID);
 		}
-		friend STRCONSTEXPR bool operator!=(Keyword const& l, Keyword const& r) noexcept
+		friend CONSTEXPR bool operator!=(Keyword const& l, Keyword const& r) noexcept
 		{
-			return str::tolower(l.name) != str::tolower(r.name) || str::tolower(l.formID) != str::tolower(r.formID);
+			return !ci::equals(l.name, r.name) || !ci::equals(l.formID, r.formID);
 		}
-		friend STRCONSTEXPR bool operator==(Keyword const& l, std::string s) noexcept
+		friend CONSTEXPR bool operator==(Keyword const& l, std::string_view const s) noexcept
 		{
-			s = str::tolower(s);
-			return str::tolower(l.name) == s || str::tolower(l.formID) == s;
+			return ci::equals(l.name, s) || ci::equals(l.formID, s);
 		}
-		friend STRCONSTEXPR bool operator!=(Keyword const& l, std::string s) noexcept
+		friend CONSTEXPR bool operator!=(Keyword const& l, std::string_view const s) noexcept
+		{
+			return !ci::equals(l.name, s) && !ci::equals(l.formID, s);
+		}
+
+		CONSTEXPR bool IsSimilarTo(const Keyword& keyword) const
+		{
+			return operator==(*this, keyword.name) || operator==(*this, keyword.formID) || ci::contains(name, keyword.name) || ci::contains(formID, keyword.formID);
+		}
+		CONSTEXPR bool IsSimilarTo(std::string_view const name_or_id, const bool requireExactMatch) const
+		{
+			return operator==(*this, name_or_id) || (!requireExactMatch && (ci::contains(name, name_or_id) || ci::contains(formID, name_or_id)));
+		}
+	};
+
+	/**
+	 * @brief	Compile-time description of a known keyword.
+	 *			Comparing a Keyword with a KeywordDefinition doesn't allocate, unlike comparing two Keyword instances.
+	 */
+	struct KeywordDefinition {
+		std::uint32_t formID;
+		std::string_view name;
+		EKeywordDisposition disposition;
+
+		/// @brief	Creates a runtime Keyword instance from this definition.
+		STRCONSTEXPR operator Keyword() const
 		{
-			s = str::tolower(s);
-			return str::tolower(l.name) != s && str::tolower(l.formID) != s;
+			return Keyword{ std::string{ name }, FormIDToString(formID), disposition };
 		}
 
-		STRCONSTEXPR bool IsSimilarTo(const Keyword& keyword) const
+		friend CONSTEXPR bool operator==(KeywordDefinition const& l, KeywordDefinition const& r) noexcept
 		{
-			const auto lc_inname{ str::tolower(keyword.name) }, lc_infid{ str::tolower(keyword.formID) }, lc_name{ str::tolower(name) }, lc_fid{ str::tolower(formID) };
-			return operator==(*this, lc_inname) || operator==(*this, lc_infid) || lc_name.find(lc_inname) != std::string::npos || lc_fid.find(lc_infid) != std::string::npos;
+			return l.formID == r.formID;
 		}
-		STRCONSTEXPR bool IsSimilarTo(std::string name_or_id, const bool requireExactMatch) const
+		/// @brief	Has the same semantics as Keyword::operator==(Keyword, Keyword); both the name and form ID must match.
+		friend CONSTEXPR bool operator==(Keyword const& l, KeywordDefinition const& r) noexcept
 		{
-			name_or_id = str::tolower(name_or_id);
-			return operator==(*this, name_or_id) || (!requireExactMatch && (str::tolower(name).find(name_or_id) != std::string::npos || str::tolower(formID).find(name_or_id) != std::string::npos));
+			return ParseFormID(l.formID) == r.formID && ci::equals(l.name, r.name);
 		}
 	};
 }
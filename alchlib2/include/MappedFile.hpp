@@ -0,0 +1,138 @@
+#pragma once
+/**
+ * @file	MappedFile.hpp
+ * @author	radj307
+ * @brief	Read-only memory mapping of a whole file.
+ */
+#include <make_exception.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+#ifdef _WIN32
+#define ALCHLIB2_MAPPEDFILE_WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace alchlib2 {
+	/**
+	 * @brief	Maps the contents of a file into memory for reading. The pages are loaded by the OS when they're first read, so opening
+	 *			a large file is fast and only the parts that are used are ever read from disk.
+	 *			The file must not be modified while it's mapped.
+	 */
+	class MappedFile {
+		std::byte const* data{ nullptr };
+		std::size_t length{ 0 };
+	#ifdef ALCHLIB2_MAPPEDFILE_WIN32
+		HANDLE mapping{ nullptr };
+	#endif
+
+		void close() noexcept
+		{
+		#ifdef ALCHLIB2_MAPPEDFILE_WIN32
+			if (data != nullptr)
+				UnmapViewOfFile(data);
+			if (mapping != nullptr)
+				CloseHandle(mapping);
+			mapping = nullptr;
+		#else
+			if (data != nullptr)
+				munmap(const_cast<std::byte*>(data), length);
+		#endif
+			data = nullptr;
+			length = 0;
+		}
+
+	public:
+		MappedFile() = default;
+		/**
+		 * @brief		Maps the given file.
+		 * @throws		ex::except when the file can't be opened or mapped.
+		 */
+		MappedFile(std::filesystem::path const& path)
+		{
+		#ifdef ALCHLIB2_MAPPEDFILE_WIN32
+			const HANDLE file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+			if (file == INVALID_HANDLE_VALUE)
+				throw make_exception("Failed to open ", path, "!");
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file, &size)) {
+				CloseHandle(file);
+				throw make_exception("Failed to get the size of ", path, "!");
+			}
+			length = $c(std::size_t, size.QuadPart);
+			if (length != 0) {
+				mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping != nullptr)
+					data = static_cast<std::byte const*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			}
+			CloseHandle(file);
+		#else
+			const int fd{ ::open(path.c_str(), O_RDONLY) };
+			if (fd == -1)
+				throw make_exception("Failed to open ", path, "!");
+			struct stat st;
+			if (fstat(fd, &st) != 0) {
+				::close(fd);
+				throw make_exception("Failed to get the size of ", path, "!");
+			}
+			length = $c(std::size_t, st.st_size);
+			if (length != 0) {
+				if (void* const ptr{ mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0) }; ptr != MAP_FAILED)
+					data = static_cast<std::byte const*>(ptr);
+			}
+			// the mapping stays valid after the file descriptor is closed
+			::close(fd);
+		#endif
+			if (length != 0 && data == nullptr) {
+				close();
+				throw make_exception("Failed to map ", path, " into memory!");
+			}
+		}
+		MappedFile(MappedFile const&) = delete;
+		MappedFile(MappedFile&& o) noexcept : data{ o.data }, length{ o.length }
+		{
+		#ifdef ALCHLIB2_MAPPEDFILE_WIN32
+			mapping = o.mapping;
+			o.mapping = nullptr;
+		#endif
+			o.data = nullptr;
+			o.length = 0;
+		}
+		~MappedFile() { close(); }
+
+		MappedFile& operator=(MappedFile const&) = delete;
+		MappedFile& operator=(MappedFile&& o) noexcept
+		{
+			if (this != &o) {
+				close();
+				data = o.data;
+				length = o.length;
+			#ifdef ALCHLIB2_MAPPEDFILE_WIN32
+				mapping = o.mapping;
+				o.mapping = nullptr;
+			#endif
+				o.data = nullptr;
+				o.length = 0;
+			}
+			return *this;
+		}
+
+		/// @brief	Gets the contents of the file.
+		std::span<const std::byte> bytes() const noexcept { return { data, length }; }
+		std::size_t size() const noexcept { return length; }
+		bool empty() const noexcept { return length == 0; }
+	};
+}
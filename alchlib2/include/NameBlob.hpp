@@ -0,0 +1,153 @@
+#pragma once
+/**
+ * @file	NameBlob.hpp
+ * @author	radj307
+ * @brief	Contiguous, lowercased copy of every name in a list of ingredients, for cache-friendly substring scans.
+ */
+#include "Ingredient.hpp"
+#include "CaseInsensitive.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace alchlib2 {
+	/**
+	 * @brief	Stores all ingredient, effect & keyword names in one lowercased buffer.
+	 *			Each section of the buffer contains the names of one kind of object, in ingredient order, each preceded by a null separator:
+	 *			"\0name\0name\0...\0"
+	 *			Since search terms never contain null characters a match can never span two names, and an exact match is
+	 *			simply a match of "\0term\0".
+	 */
+	class NameBlob {
+	public:
+		enum class Section : std::uint8_t {
+			IngredientNames,
+			EffectNames,
+			KeywordNames,
+			KeywordFormIDs,
+		};
+		static constexpr std::size_t SectionCount{ 4 };
+
+	private:
+		std::string blob;
+		/// @brief	The [begin, end) offsets of each section in the blob.
+		std::array<std::pair<std::uint32_t, std::uint32_t>, SectionCount> sections{};
+		/// @brief	For each section, the offset at which each ingredient's names begin. Each has (ingredientCount + 1) elements.
+		std::array<std::vector<std::uint32_t>, SectionCount> ingredientOffsets;
+
+		void append(std::string_view const name)
+		{
+			blob += '\0';
+			std::transform(name.begin(), name.end(), std::back_inserter(blob), ci::tolower);
+		}
+
+		template<typename TAppendNames>
+		void add_section(Section const section, std::vector<Ingredient> const& ingredients, TAppendNames const& appendNames)
+		{
+			auto& offsets{ ingredientOffsets[$c(std::size_t, section)] };
+			offsets.reserve(ingredients.size() + 1);
+
+			const auto begin{ $c(std::uint32_t, blob.size()) };
+			for (const auto& ingredient : ingredients) {
+				offsets.emplace_back($c(std::uint32_t, blob.size()));
+				appendNames(ingredient);
+			}
+			offsets.emplace_back($c(std::uint32_t, blob.size()));
+			blob += '\0';
+			sections[$c(std::size_t, section)] = { begin, $c(std::uint32_t, blob.size()) };
+		}
+
+	public:
+		NameBlob() = default;
+		NameBlob(std::vector<Ingredient> const& ingredients)
+		{
+			add_section(Section::IngredientNames, ingredients, [this](Ingredient const& ingredient) {
+				append(ingredient.name);
+			});
+			add_section(Section::EffectNames, ingredients, [this](Ingredient const& ingredient) {
+				for (const auto& effect : ingredient.effects)
+					append(effect.name);
+			});
+			add_section(Section::KeywordNames, ingredients, [this](Ingredient const& ingredient) {
+				for (const auto& effect : ingredient.effects)
+					for (const auto& keyword : effect.keywords)
+						append(keyword.name);
+			});
+			add_section(Section::KeywordFormIDs, ingredients, [this](Ingredient const& ingredient) {
+				for (const auto& effect : ingredient.effects)
+					for (const auto& keyword : effect.keywords)
+						append(keyword.formID);
+			});
+			blob.shrink_to_fit();
+		}
+
+		/// @brief	Gets the number of ingredients that this blob was built from.
+		std::size_t ingredient_count() const noexcept { return ingredientOffsets.front().empty() ? 0 : ingredientOffsets.front().size() - 1; }
+		/// @brief	Gets the underlying buffer.
+		std::string_view data() const noexcept { return blob; }
+
+		/**
+		 * @brief				Marks every ingredient with a name in the given section that matches the search term.
+		 * @param section		The section to scan.
+		 * @param search_term	The term to search for. Case is ignored.
+		 * @param exact			When true, names must equal the search term; otherwise they must contain it.
+		 * @param matches		A vector with one element per ingredient. Elements are set to true for matching ingredients, and never set to false.
+		 */
+		void scan(Section const section, std::string_view const search_term, bool const exact, std::vector<bool>& matches) const
+		{
+			const auto& offsets{ ingredientOffsets[$c(std::size_t, section)] };
+			const auto [begin, end] { sections[$c(std::size_t, section)] };
+			if (offsets.empty() || search_term.find('\0') != std::string_view::npos)
+				return;
+
+			std::string needle;
+			if (exact) {
+				needle.reserve(search_term.size() + 2);
+				needle += '\0';
+				needle += search_term;
+				needle += '\0';
+			}
+			const std::string_view term{ exact ? std::string_view{ needle } : search_term };
+			const std::string_view haystack{ blob.data(), end };
+
+			for (std::size_t pos{ begin }; pos < end; ) {
+				const auto hit{ ci::find_in_folded(haystack.substr(pos), term) };
+				if (hit == std::string_view::npos)
+					break;
+				// map the hit back to its ingredient, then skip the rest of that ingredient's names
+				const auto it{ std::upper_bound(offsets.begin(), offsets.end(), $c(std::uint32_t, pos + hit)) };
+				if (it == offsets.end()) //< an empty search term matched the section's trailing separator
+					break;
+				const auto index{ $c(std::size_t, std::distance(offsets.begin(), it) - 1) };
+				matches[index] = true;
+				pos = *it;
+			}
+		}
+
+		/**
+		 * @brief					Finds all ingredients that have a name matching the search term, using the same rules as Registry::copy_inclusive_filter.
+		 * @param search_term		The term to search for. Case is ignored.
+		 * @param exact				When true, names must equal the search term; otherwise they must contain it.
+		 * @param searchIngredients	When true, ingredient names are searched.
+		 * @param searchEffects		When true, effect names are searched.
+		 * @param searchKeywords	When true, keyword names are searched. Keyword form IDs are also searched when exact is false.
+		 * @returns					A vector with one element per ingredient, where matching ingredients are true.
+		 */
+		std::vector<bool> search(std::string_view const search_term, bool const exact, bool const searchIngredients, bool const searchEffects = false, bool const searchKeywords = false) const
+		{
+			std::vector<bool> matches(ingredient_count(), false);
+			if (searchIngredients)
+				scan(Section::IngredientNames, search_term, exact, matches);
+			if (searchEffects)
+				scan(Section::EffectNames, search_term, exact, matches);
+			if (searchKeywords) {
+				scan(Section::KeywordNames, search_term, exact, matches);
+				if (!exact) scan(Section::KeywordFormIDs, search_term, exact, matches);
+			}
+			return matches;
+		}
+	};
+}
@@ -0,0 +1,187 @@
+#pragma once
+/**
+ * @file	NameCompleter.hpp
+ * @author	radj307
+ * @brief	Sorted, case-folded index of every ingredient, effect & keyword name, for prefix completion.
+ */
+#include "Ingredient.hpp"
+#include "CaseInsensitive.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace alchlib2 {
+	/// @brief	The kind of object that a name belongs to.
+	enum class ENameKind : std::uint8_t {
+		Ingredient,
+		Effect,
+		Keyword,
+	};
+
+	/// @brief	Gets the lowercase name of a name kind, for display.
+	constexpr std::string_view GetNameKindName(ENameKind const kind) noexcept
+	{
+		switch (kind) {
+		case ENameKind::Ingredient: return "ingredient";
+		case ENameKind::Effect: return "effect";
+		case ENameKind::Keyword: return "keyword";
+		default: return "unknown";
+		}
+	}
+
+	/**
+	 * @brief	Completes partial ingredient, effect & keyword names.
+	 *
+	 *			Every word of every name is stored as a case-folded key that runs from the start of that word to the end of the name,
+	 *			in one sorted array. The keys that begin with a prefix are therefore a contiguous range, which is found with two
+	 *			binary searches; "heal" completes both "Healing Thistle" and "Restore Health".
+	 */
+	class NameCompleter {
+	public:
+		struct Completion {
+			/// @brief	The name, as it's written in the registry.
+			std::string_view name;
+			ENameKind kind;
+			/// @brief	The number of ingredients that have this name, which is used to rank completions.
+			std::uint32_t count;
+		};
+
+	private:
+		struct Name {
+			std::string name;
+			ENameKind kind;
+			std::uint32_t count;
+		};
+		struct Key {
+			/// @brief	The case-folded name, starting from the beginning of one of its words.
+			std::string key;
+			/// @brief	The index of the name in names.
+			std::uint32_t name;
+			/// @brief	The index of the word that the key starts at. 0 means the key is the whole name.
+			std::uint32_t word;
+		};
+		std::vector<Name> names;
+		/// @brief	Sorted by key.
+		std::vector<Key> keys;
+
+		void add_keys(std::uint32_t const index)
+		{
+			std::string folded{ names[index].name };
+			std::transform(folded.begin(), folded.end(), folded.begin(), ci::tolower);
+
+			std::uint32_t word{ 0 };
+			for (std::size_t pos{ 0 }; pos < folded.size(); ++pos) {
+				if (folded[pos] == ' ' || (pos != 0 && folded[pos - 1] != ' '))
+					continue;
+				keys.emplace_back(Key{ folded.substr(pos), index, word++ });
+			}
+		}
+
+	public:
+		NameCompleter() = default;
+		NameCompleter(std::vector<Ingredient> const& ingredients)
+		{
+			// each name is counted once per ingredient that has it
+			std::unordered_map<std::string, std::uint32_t> indices;
+			const auto add{ [&](std::string const& name, ENameKind const kind, std::uint32_t const ingredient, std::vector<std::uint32_t>& lastIngredient) {
+				if (name.empty())
+					return;
+				std::string id{ name };
+				id += $c(char, kind);
+				const auto [it, inserted] { indices.try_emplace(std::move(id), $c(std::uint32_t, names.size())) };
+				if (inserted) {
+					names.emplace_back(Name{ name, kind, 0 });
+					lastIngredient.emplace_back(ingredient);
+				}
+				else if (lastIngredient[it->second] == ingredient)
+					return;
+				lastIngredient[it->second] = ingredient;
+				++names[it->second].count;
+			} };
+
+			std::vector<std::uint32_t> lastIngredient;
+			for (std::uint32_t i{ 0 }; i < ingredients.size(); ++i) {
+				const auto& ingredient{ ingredients[i] };
+				add(ingredient.name, ENameKind::Ingredient, i, lastIngredient);
+				for (const auto& effect : ingredient.effects) {
+					add(effect.name, ENameKind::Effect, i, lastIngredient);
+					for (const auto& keyword : effect.keywords)
+						add(keyword.name, ENameKind::Keyword, i, lastIngredient);
+				}
+			}
+
+			for (std::uint32_t i{ 0 }; i < names.size(); ++i)
+				add_keys(i);
+			std::sort(keys.begin(), keys.end(), [](auto&& l, auto&& r) { return l.key < r.key; });
+		}
+
+		/// @brief	Gets the number of unique names.
+		std::size_t size() const noexcept { return names.size(); }
+		bool empty() const noexcept { return names.empty(); }
+
+		/**
+		 * @brief			Finds the names that have a word beginning with the given prefix.
+		 *					Names that begin with the prefix are ranked first, and a name that equals the prefix is ranked before all
+		 *					others. Then, names that more ingredients have are ranked first, followed by shorter names. Any remaining
+		 *					ties are in alphabetical order.
+		 * @param prefix	The prefix to complete. Case is ignored. An empty prefix matches every name.
+		 * @param limit		The maximum number of completions to return, or 0 for no limit.
+		 * @returns			The completions, best first. Each name appears at most once.
+		 */
+		std::vector<Completion> complete(std::string_view const prefix, std::size_t const limit = 0) const
+		{
+			std::string folded{ prefix };
+			std::transform(folded.begin(), folded.end(), folded.begin(), ci::tolower);
+
+			const auto first{ std::lower_bound(keys.begin(), keys.end(), folded, [](Key const& key, std::string const& value) { return key.key < value; }) };
+			const auto last{ std::find_if(first, keys.end(), [&folded](Key const& key) { return !key.key.starts_with(folded); }) };
+
+			// keep the earliest matching word of each name
+			struct Match {
+				std::uint32_t name;
+				std::uint32_t word;
+				bool exact;
+			};
+			std::vector<Match> matches;
+			std::unordered_map<std::uint32_t, std::size_t> positions;
+			for (auto it{ first }; it != last; ++it) {
+				const bool exact{ it->word == 0 && it->key.size() == folded.size() };
+				if (const auto [pos, inserted] { positions.try_emplace(it->name, matches.size()) }; inserted)
+					matches.emplace_back(Match{ it->name, it->word, exact });
+				else if (auto& match{ matches[pos->second] }; it->word < match.word) {
+					match.word = it->word;
+					match.exact = exact;
+				}
+			}
+
+			const auto better{ [this](Match const& l, Match const& r) {
+				if (l.exact != r.exact)
+					return l.exact;
+				if ((l.word == 0) != (r.word == 0))
+					return l.word == 0;
+				const auto& ln{ names[l.name] }, & rn{ names[r.name] };
+				if (ln.count != rn.count)
+					return ln.count > rn.count;
+				if (ln.name.size() != rn.name.size())
+					return ln.name.size() < rn.name.size();
+				if (const auto cmp{ ci::compare(ln.name, rn.name) }; cmp != 0)
+					return cmp < 0;
+				return ln.kind < rn.kind;
+			} };
+			const auto count{ limit == 0 ? matches.size() : std::min(limit, matches.size()) };
+			std::partial_sort(matches.begin(), matches.begin() + count, matches.end(), better);
+
+			std::vector<Completion> completions;
+			completions.reserve(count);
+			for (std::size_t i{ 0 }; i < count; ++i) {
+				const auto& name{ names[matches[i].name] };
+				completions.emplace_back(Completion{ name.name, name.kind, name.count });
+			}
+			return completions;
+		}
+	};
+}
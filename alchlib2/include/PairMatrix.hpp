@@ -0,0 +1,187 @@
+#pragma once
+/**
+ * @file	PairMatrix.hpp
+ * @author	radj307
+ * @brief	Precomputed matrix of which ingredient pairs share effects, and which effects they share.
+ */
+#include "EffectTable.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace alchlib2 {
+	/**
+	 * @brief	Stores a shared-effect bitmask for every unordered pair of ingredients in an EffectTable.
+	 *			Only the upper triangle (a < b) is stored, packed row by row, so an N-ingredient matrix uses N * (N - 1) / 2 bytes.
+	 *
+	 *			Each mask describes the pair (a, b) with one bit per effect slot:
+	 *			- Bits 0-3 are set for each of a's slots whose effect b also has.
+	 *			- Bits 4-7 are set for each of b's slots whose effect a also has.
+	 *			A mask of 0 means the two ingredients can't be combined.
+	 */
+	class PairMatrix {
+	public:
+		using mask_t = std::uint8_t;
+		static_assert(EffectTable::SlotsPerIngredient * 2 <= sizeof(mask_t) * 8, "PairMatrix masks are too small to hold every slot of both ingredients!");
+
+		/// @brief	The number of ingredients in each square tile processed by one task during construction.
+		static constexpr std::size_t BlockSize{ 64 };
+		/// @brief	Matrices for fewer ingredients than this are built on the calling thread.
+		static constexpr std::size_t ParallelThreshold{ 512 };
+
+	private:
+		std::size_t n{ 0 };
+		std::vector<mask_t> masks;
+
+		/// @brief	Gets the position of the pair (a, b) in the packed upper triangle. a must be less than b.
+		constexpr std::size_t index_of(std::size_t const a, std::size_t const b) const noexcept
+		{
+			return a * (2 * n - a - 1) / 2 + (b - a - 1);
+		}
+
+		/// @brief	Packs the effect IDs of one ingredient into a single integer, with slot i in bits [16i, 16i + 16).
+		static constexpr std::uint64_t pack(EffectTable::EffectID const* ids) noexcept
+		{
+			static_assert(EffectTable::SlotsPerIngredient == 4 && sizeof(EffectTable::EffectID) == 2, "PairMatrix::pack expects 4 slots of 16-bit effect IDs!");
+			return $c(std::uint64_t, ids[0]) | ($c(std::uint64_t, ids[1]) << 16) | ($c(std::uint64_t, ids[2]) << 32) | ($c(std::uint64_t, ids[3]) << 48);
+		}
+
+		/**
+		 * @brief	Computes the mask for a single pair from the packed effect IDs of both ingredients.
+		 *			Each of a's effects is compared against all 4 of b's effects at once by finding the zero lanes of (b XOR a[i]).
+		 */
+		static constexpr mask_t compute(std::uint64_t const a, std::uint64_t const b) noexcept
+		{
+			constexpr std::uint64_t low15{ 0x7FFF7FFF7FFF7FFFull }, lanes{ 0x0001000100010001ull };
+			// gathers bits 0, 16, 32 & 48 into bits 48-51
+			constexpr std::uint64_t gather{ (1ull << 48) | (1ull << 33) | (1ull << 18) | (1ull << 3) };
+
+			unsigned aMask{ 0 }, bMask{ 0 };
+			for (unsigned i{ 0 }; i < EffectTable::SlotsPerIngredient; ++i) {
+				const auto id{ (a >> (16 * i)) & 0xFFFF };
+				const auto x{ b ^ (id * lanes) };
+				// the high bit of each lane is set when that lane of x is zero
+				const auto zero{ ~(((x & low15) + low15) | x | low15) };
+				const auto matches{ $c(unsigned, (((zero >> 15) * gather) >> 48) & 0xF) & (id == EffectTable::NoEffect ? 0u : 0xFu) };
+				aMask |= $c(unsigned, matches != 0) << i;
+				bMask |= matches;
+			}
+			return $c(mask_t, aMask | (bMask << EffectTable::SlotsPerIngredient));
+		}
+
+		/// @brief	Fills in every pair whose first ingredient is in [rowBegin, rowEnd) and whose second is in [colBegin, colEnd).
+		void compute_block(std::span<const EffectTable::EffectID> const ids, std::size_t const rowBegin, std::size_t const rowEnd, std::size_t const colBegin, std::size_t const colEnd) noexcept
+		{
+			for (std::size_t a{ rowBegin }; a < rowEnd; ++a) {
+				const auto aIDs{ pack(ids.data() + EffectTable::first_slot_of(a)) };
+				auto* out{ masks.data() + index_of(a, std::max(colBegin, a + 1)) };
+				for (std::size_t b{ std::max(colBegin, a + 1) }; b < colEnd; ++b)
+					*out++ = compute(aIDs, pack(ids.data() + EffectTable::first_slot_of(b)));
+			}
+		}
+
+	public:
+		PairMatrix() = default;
+		/**
+		 * @brief				Builds the matrix for every ingredient in the given table.
+		 *						The matrix is divided into BlockSize x BlockSize tiles so that both ingredients' effect IDs stay in cache,
+		 *						and the tiles are shared between threads when there are at least ParallelThreshold ingredients.
+		 * @param table			The effect table to build the matrix from. Only the first SlotsPerIngredient effects of each ingredient are considered.
+		 * @param threadCount	The maximum number of threads to use, or 0 to use one per hardware thread.
+		 */
+		PairMatrix(EffectTable const& table, unsigned threadCount = 0) : n{ table.ingredient_count() }, masks(n < 2 ? 0 : n * (n - 1) / 2, 0)
+		{
+			const auto ids{ table.EffectIDs() };
+			const auto blockCount{ (n + BlockSize - 1) / BlockSize };
+
+			// enumerate the tiles on or above the diagonal
+			std::vector<std::pair<std::size_t, std::size_t>> tiles;
+			tiles.reserve(blockCount * (blockCount + 1) / 2);
+			for (std::size_t row{ 0 }; row < blockCount; ++row)
+				for (std::size_t col{ row }; col < blockCount; ++col)
+					tiles.emplace_back(row, col);
+
+			std::atomic<std::size_t> next{ 0 };
+			const auto worker{ [&] {
+				for (auto i{ next.fetch_add(1, std::memory_order_relaxed) }; i < tiles.size(); i = next.fetch_add(1, std::memory_order_relaxed)) {
+					const auto [row, col] { tiles[i] };
+					compute_block(ids, row * BlockSize, std::min(n, (row + 1) * BlockSize), col * BlockSize, std::min(n, (col + 1) * BlockSize));
+				}
+			} };
+
+			if (threadCount == 0)
+				threadCount = std::max(1u, std::thread::hardware_concurrency());
+			threadCount = $c(unsigned, std::min<std::size_t>(threadCount, tiles.size()));
+
+			if (n < ParallelThreshold || threadCount <= 1) {
+				worker();
+				return;
+			}
+
+			std::vector<std::jthread> threads;
+			threads.reserve(threadCount - 1);
+			for (unsigned i{ 1 }; i < threadCount; ++i)
+				threads.emplace_back(worker);
+			worker();
+		}
+
+		/// @brief	Gets the number of ingredients in the matrix.
+		std::size_t ingredient_count() const noexcept { return n; }
+		/// @brief	Gets the packed upper triangle.
+		std::span<const mask_t> data() const noexcept { return masks; }
+
+		/**
+		 * @brief	Gets the shared-effect mask of the given pair, from the perspective of the first ingredient.
+		 *			Bits 0-3 are a's shared slots, and bits 4-7 are b's shared slots.
+		 * @returns	The shared-effect mask, which is 0 when a == b or when the ingredients don't share any effects.
+		 */
+		mask_t GetMask(std::size_t const a, std::size_t const b) const noexcept
+		{
+			if (a == b)
+				return 0;
+			if (a < b)
+				return masks[index_of(a, b)];
+			// swap the two halves so that the low bits still refer to a
+			const auto mask{ masks[index_of(b, a)] };
+			return $c(mask_t, (mask >> EffectTable::SlotsPerIngredient) | (mask << EffectTable::SlotsPerIngredient));
+		}
+
+		/// @brief	Checks if the given ingredients share at least one effect.
+		bool Combines(std::size_t const a, std::size_t const b) const noexcept
+		{
+			return GetMask(a, b) != 0;
+		}
+
+		/**
+		 * @brief	Gets the IDs of the effects shared by the given ingredients.
+		 * @param table	The effect table that this matrix was built from.
+		 * @returns	The shared effect IDs, in the order they appear in a's effects.
+		 */
+		std::vector<EffectTable::EffectID> GetSharedEffects(EffectTable const& table, std::size_t const a, std::size_t const b) const
+		{
+			std::vector<EffectTable::EffectID> shared;
+			const auto mask{ GetMask(a, b) };
+			const auto ids{ table.EffectIDs() };
+			for (std::size_t i{ 0 }; i < EffectTable::SlotsPerIngredient; ++i)
+				if (mask & (1u << i))
+					shared.emplace_back(ids[EffectTable::first_slot_of(a) + i]);
+			return shared;
+		}
+
+		/**
+		 * @brief		Calls the given function with each ingredient that shares at least one effect with the given ingredient, in ingredient order.
+		 * @param a		An ingredient index.
+		 * @param func	A callable with the signature void(std::size_t b, mask_t mask), where mask is GetMask(a, b).
+		 */
+		template<typename TFunc>
+		void ForEachPartner(std::size_t const a, TFunc&& func) const
+		{
+			for (std::size_t b{ 0 }; b < n; ++b)
+				if (const auto mask{ GetMask(a, b) }; mask != 0)
+					func(b, mask);
+		}
+	};
+}
@@ -2,48 +2,98 @@
 #include "Effect.hpp"
 #include "keywords/VanillaKeywords.h"
 
+#include <make_exception.hpp>
+
 namespace alchlib2 {
 	struct Potion : INamedObject {
+		/// @brief	Returned by GetStrongestEffectIndex when the potion doesn't have any effects.
+		static constexpr std::size_t npos{ $c(std::size_t, -1) };
+
+		/**
+		 * @brief	The potion's effects.
+		 *			The strongest effect & poison classification are cached, so UpdateStrongestEffect must be called after modifying
+		 *			the effects directly. The member functions that modify effects keep the cache valid themselves.
+		 */
 		std::vector<Effect> effects;
 
 		STRCONSTEXPR Potion() {}
-		STRCONSTEXPR Potion(std::string const& name, std::vector<Effect> const& effects) : INamedObject(name), effects{ effects } {}
+		STRCONSTEXPR Potion(std::string const& name, std::vector<Effect> const& effects) : INamedObject(name), effects{ effects } { UpdateStrongestEffect(); }
+		STRCONSTEXPR Potion(std::string const& name, std::vector<Effect>&& effects) : INamedObject(name), effects{ std::move(effects) } { UpdateStrongestEffect(); }
 
-		[[nodiscard]] Effect GetStrongestEffect() const noexcept
+		/// @brief	Gets the index of the effect with the largest magnitude, or npos when there aren't any effects. The first of several equal effects is used.
+		[[nodiscard]] static CONSTEXPR std::size_t FindStrongestEffect(std::vector<Effect> const& effects) noexcept
 		{
-			std::vector<Effect>::const_iterator strongest;
-			for (auto it{ effects.begin() }; it != effects.end(); ++it) {
-				if (strongest == effects.end() || it->magnitude > strongest->magnitude) {
-					strongest = it;
-				}
-			}
-			return *strongest;
+			std::size_t strongest{ npos };
+			for (std::size_t i{ 0 }; i < effects.size(); ++i)
+				if (strongest == npos || effects[i].magnitude > effects[strongest].magnitude)
+					strongest = i;
+			return strongest;
+		}
+
+		/// @brief	Gets the index of the strongest effect, or npos when there aren't any effects.
+		[[nodiscard]] CONSTEXPR std::size_t GetStrongestEffectIndex() const noexcept { return strongestIndex; }
+		/**
+		 * @brief	Gets the strongest effect.
+		 * @throws	ex::except when the potion doesn't have any effects.
+		 */
+		[[nodiscard]] Effect const& GetStrongestEffect() const
+		{
+			if (strongestIndex == npos)
+				throw make_exception("Potion \"", name, "\" doesn't have any effects!");
+			return effects[strongestIndex];
 		}
 
-		[[nodiscard]] bool IsPoison() const noexcept
+		/// @brief	Checks whether the strongest effect is harmful. Potions without any effects aren't poisons.
+		[[nodiscard]] CONSTEXPR bool IsPoison() const noexcept { return isPoison; }
+
+		/// @brief	Finds the strongest effect & poison classification again. Call this after modifying the effects directly.
+		CONSTEXPR void UpdateStrongestEffect() noexcept
 		{
-			return GetStrongestEffect().HasAnyKeyword(keywords::MagicAlchHarmful);
+			strongestIndex = FindStrongestEffect(effects);
+			update_poison();
 		}
 
 		template<var::any_same_or_convertible<Keyword>... TKeywords> requires var::at_least_one<TKeywords...>
-		[[nodiscard]] CONSTEXPR bool AnyEffectHasKeyword(TKeywords const&... keywords)
+		[[nodiscard]] CONSTEXPR bool AnyEffectHasKeyword(TKeywords const&... keywords) const
 		{
 			return std::any_of(effects.begin(), effects.end(), [&](Effect const& effect) -> bool {
 				return effect.HasAnyKeyword(keywords...);
 			});
 		}
 
-		[[nodiscard]] CONSTEXPR void ModAllMagnitudes(const float multiplier)
+		/// @brief	Removes every effect that satisfies the predicate.
+		template<typename TPredicate>
+		CONSTEXPR void RemoveEffectsIf(TPredicate&& pred)
 		{
-			for (auto& effect : effects) {
-				effect.magnitude *= multiplier;
+			effects.erase(std::remove_if(effects.begin(), effects.end(), std::forward<TPredicate>(pred)), effects.end());
+			UpdateStrongestEffect();
+		}
+
+		CONSTEXPR void ModAllMagnitudes(const float multiplier)
+		{
+			// the strongest effect is found in the same pass, since rounding could make two magnitudes equal
+			strongestIndex = npos;
+			for (std::size_t i{ 0 }; i < effects.size(); ++i) {
+				effects[i].magnitude *= multiplier;
+				if (strongestIndex == npos || effects[i].magnitude > effects[strongestIndex].magnitude)
+					strongestIndex = i;
 			}
+			update_poison();
 		}
-		[[nodiscard]] CONSTEXPR void ModAllDurations(const float multiplier)
+		CONSTEXPR void ModAllDurations(const float multiplier)
 		{
 			for (auto& effect : effects) {
 				effect.duration = $c(unsigned, std::round($c(float, effect.duration) * multiplier));
 			}
 		}
+
+	private:
+		std::size_t strongestIndex{ npos };
+		bool isPoison{ false };
+
+		CONSTEXPR void update_poison() noexcept
+		{
+			isPoison = strongestIndex != npos && effects[strongestIndex].HasAnyKeyword(keywords::MagicAlchHarmful);
+		}
 	};
 }
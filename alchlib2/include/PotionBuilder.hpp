@@ -1,5 +1,6 @@
 #pragma once
 #include "Potion.hpp"
+#include "Registry.hpp"
 #include "Formula.hpp"
 #include "PerkBase.hpp"
 
@@ -50,16 +51,18 @@ namespace alchlib2 {
 		PotionBuilder(AlchemyCoreFormula const& coreFormula) : coreFormula{ coreFormula } {}
 		PotionBuilder(AlchemyCoreGameSettings const& coreGameSettings) : coreFormula{ coreGameSettings } {}
 
-		[[nodiscard]] std::string GetNameFromEffects(std::vector<Effect> const& effects) const
+		/**
+		 * @brief			Gets the name of a potion from its effects, which depends on its strongest effect & how many effects it has.
+		 * @param effects	The potion's effects.
+		 * @param strongest	The index of the strongest effect, as returned by Potion::FindStrongestEffect.
+		 */
+		[[nodiscard]] static std::string GetNameFromEffects(std::vector<Effect> const& effects, std::size_t const strongest)
 		{
 			std::string name;
-			auto strongest{ effects.end() };
-			for (auto it{ effects.begin() }; it != effects.end(); ++it)
-				if (strongest == effects.end() || it->magnitude > strongest->magnitude)
-					strongest = it;
-			if (strongest != effects.end()) {
-				name = " of " + strongest->name;
-				if (const auto& disposition{ strongest->GetDisposition() }; disposition >= EKeywordDisposition::Negative)
+			if (strongest != Potion::npos) {
+				const auto& effect{ effects[strongest] };
+				name = " of " + effect.name;
+				if (const auto& disposition{ effect.GetDisposition() }; disposition >= EKeywordDisposition::Negative)
 					name = "Poison" + name;
 				else if (effects.size() > 2)
 					name = "Elixir" + name;
@@ -72,25 +75,58 @@ namespace alchlib2 {
 				name = "Potion";
 			return name;
 		}
-		[[nodiscard]] Potion Build(std::vector<Ingredient> const& ingredients, std::vector<Perk> const& perks) const
+		[[nodiscard]] static std::string GetNameFromEffects(std::vector<Effect> const& effects)
 		{
-			auto common{ get_common_effects(ingredients) };
-			for (auto& effect : common) {
-				if (effect.HasAnyKeyword(keywords::MagicAlchDurationBased))
-					effect.duration = std::round(coreFormula.GetResult(effect.magnitude));
-				else
-					effect.magnitude = std::round(coreFormula.GetResult(effect.magnitude));
-
+			return GetNameFromEffects(effects, Potion::FindStrongestEffect(effects));
+		}
+		/// @brief	Applies perks to effects that the alchemy formula has already been applied to, then builds a potion from them.
+		[[nodiscard]] static Potion BuildFromScaledEffects(std::vector<Effect>&& effects, std::vector<Perk> const& perks)
+		{
+			for (auto& effect : effects)
 				for (const auto& it : perks)
 					it.ApplyToEffect(effect);
-			}
-			Potion p{ GetNameFromEffects(common), common };
+
+			Potion p{ std::string{}, std::move(effects) };
+			p.name = GetNameFromEffects(p.effects, p.GetStrongestEffectIndex());
 
 			for (const auto& it : perks)
 				it.ApplyToPotion(p);
 
 			return p;
 		}
+		/// @brief	Applies the alchemy formula & perks to the given common effects, then builds a potion from them.
+		[[nodiscard]] Potion BuildFromCommonEffects(std::vector<Effect>&& common, std::vector<Perk> const& perks) const
+		{
+			for (auto& effect : common) {
+				if (effect.HasAnyKeyword(keywords::MagicAlchDurationBased))
+					effect.duration = std::round(coreFormula.GetResult(effect.magnitude));
+				else
+					effect.magnitude = std::round(coreFormula.GetResult(effect.magnitude));
+			}
+			return BuildFromScaledEffects(std::move(common), perks);
+		}
+		[[nodiscard]] Potion Build(std::vector<Ingredient> const& ingredients, std::vector<Perk> const& perks) const
+		{
+			return BuildFromCommonEffects(get_common_effects(ingredients), perks);
+		}
+		/**
+		 * @brief			Builds a potion from ingredients in a registry, using the registry's EffectTable to find the common effects.
+		 *					This produces the same potion as building from copies of the ingredients, but is faster when building many potions from the same registry.
+		 * @param registry	The registry that contains the ingredients.
+		 * @param indices	The indices of the ingredients in the registry.
+		 * @param perks		The perks to apply.
+		 */
+		[[nodiscard]] Potion Build(Registry const& registry, std::span<const std::size_t> const indices, std::vector<Perk> const& perks) const
+		{
+			if (const auto& table{ registry.GetEffectTable() }; table.is_complete())
+				return BuildFromCommonEffects(table.GetCommonEffects(registry.Ingredients, indices), perks);
+
+			std::vector<Ingredient> ingredients;
+			ingredients.reserve(indices.size());
+			for (const auto index : indices)
+				ingredients.emplace_back(registry.Ingredients.at(index));
+			return Build(ingredients, perks);
+		}
 		template<var::any_same_or_convertible<Perk>... TPerks>
 		[[nodiscard]] Potion Build(std::vector<Ingredient> const& ingredients, TPerks&&... perks) const
 		{
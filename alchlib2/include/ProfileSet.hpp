@@ -0,0 +1,125 @@
+#pragma once
+/**
+ * @file	ProfileSet.hpp
+ * @author	radj307
+ * @brief	Evaluates potions against many character profiles at once.
+ */
+#include "PotionBuilder.hpp"
+
+#include <array>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace alchlib2 {
+	/// @brief	The game settings & perks of one character.
+	struct Profile {
+		std::string name;
+		AlchemyCoreGameSettings gameSettings;
+		std::vector<Perk> perks;
+	};
+
+	/**
+	 * @brief	A list of profiles that potions are built for together.
+	 *
+	 *			The common effects of a recipe don't depend on the profile, so they're found once per recipe rather than once per
+	 *			profile. The alchemy formula's factors are computed once per profile when the set is created, and are stored
+	 *			contiguously so that each effect is scaled for every profile in one loop. The results are identical to building the
+	 *			potion with a PotionBuilder for each profile.
+	 */
+	class ProfileSet {
+		std::vector<Profile> profiles;
+		/// @brief	The factors of each profile's alchemy formula. factors[i][p] is the i-th factor of the p-th profile.
+		std::array<std::vector<float>, AlchemyCoreFormula::FactorCount> factors;
+		/// @brief	Each profile's compiled formula, when a formula config is used instead of the vanilla formula.
+		std::vector<FormulaProgram> programs;
+
+	public:
+		/**
+		 * @param profiles	The profiles to build potions for.
+		 * @param formula	The formula config to use instead of the vanilla formula, which is compiled for each profile's game settings.
+		 */
+		ProfileSet(std::vector<Profile>&& profiles, std::optional<FormulaConfig> const& formula = std::nullopt) : profiles{ std::move(profiles) }
+		{
+			if (formula.has_value()) {
+				const FormulaExpression expression{ formula->expression };
+				programs.reserve(this->profiles.size());
+				for (const auto& profile : this->profiles)
+					programs.emplace_back(expression.Compile(profile.gameSettings, formula->terms));
+				return;
+			}
+
+			for (auto& column : factors)
+				column.reserve(this->profiles.size());
+			for (const auto& profile : this->profiles) {
+				const auto profileFactors{ AlchemyCoreFormula::GetFactors(profile.gameSettings) };
+				for (std::size_t i{ 0 }; i < AlchemyCoreFormula::FactorCount; ++i)
+					factors[i].emplace_back(profileFactors[i]);
+			}
+		}
+
+		std::size_t size() const noexcept { return profiles.size(); }
+		bool empty() const noexcept { return profiles.empty(); }
+		Profile const& operator[](std::size_t const index) const { return profiles[index]; }
+		auto begin() const { return profiles.begin(); }
+		auto end() const { return profiles.end(); }
+
+		/**
+		 * @brief			Builds the potion that each profile would make from the given common effects.
+		 * @param common	The unscaled common effects of the ingredients.
+		 * @returns			One potion per profile, in the same order as the profiles.
+		 */
+		[[nodiscard]] std::vector<Potion> Build(std::vector<Effect> const& common) const
+		{
+			const auto count{ profiles.size() };
+			std::vector<std::vector<Effect>> effects(count, common);
+			std::vector<float> scaled(count);
+
+			for (std::size_t e{ 0 }; e < common.size(); ++e) {
+				const float base{ common[e].magnitude };
+				if (programs.empty()) {
+					// multiply in the same order as AlchemyCoreFormula::GetResult so that the results are identical
+					for (std::size_t p{ 0 }; p < count; ++p)
+						scaled[p] = base * factors[0][p] * factors[1][p] * factors[2][p] * factors[3][p] * factors[4][p];
+				}
+				else {
+					for (std::size_t p{ 0 }; p < count; ++p)
+						scaled[p] = programs[p](base);
+				}
+
+				if (common[e].HasAnyKeyword(keywords::MagicAlchDurationBased)) {
+					for (std::size_t p{ 0 }; p < count; ++p)
+						effects[p][e].duration = std::round(scaled[p]);
+				}
+				else {
+					for (std::size_t p{ 0 }; p < count; ++p)
+						effects[p][e].magnitude = std::round(scaled[p]);
+				}
+			}
+
+			std::vector<Potion> potions;
+			potions.reserve(count);
+			for (std::size_t p{ 0 }; p < count; ++p)
+				potions.emplace_back(PotionBuilder::BuildFromScaledEffects(std::move(effects[p]), profiles[p].perks));
+			return potions;
+		}
+		/// @brief	Builds the potion that each profile would make from the given ingredients.
+		[[nodiscard]] std::vector<Potion> Build(std::vector<Ingredient> const& ingredients) const
+		{
+			return Build(get_common_effects(ingredients));
+		}
+		/// @brief	Builds the potion that each profile would make from the ingredients at the given indices in a registry.
+		[[nodiscard]] std::vector<Potion> Build(Registry const& registry, std::span<const std::size_t> const indices) const
+		{
+			if (const auto& table{ registry.GetEffectTable() }; table.is_complete())
+				return Build(table.GetCommonEffects(registry.Ingredients, indices));
+
+			std::vector<Ingredient> ingredients;
+			ingredients.reserve(indices.size());
+			for (const auto index : indices)
+				ingredients.emplace_back(registry.Ingredients.at(index));
+			return Build(ingredients);
+		}
+	};
+}
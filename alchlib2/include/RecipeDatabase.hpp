@@ -0,0 +1,491 @@
+#pragma once
+/**
+ * @file	RecipeDatabase.hpp
+ * @author	radj307
+ * @brief	Precomputed file of every valid recipe in a registry, which is memory-mapped and queried without building any potions.
+ */
+#include "PotionBuilder.hpp"
+#include "MappedFile.hpp"
+
+#include <make_exception.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace alchlib2 {
+	/**
+	 * @brief	A file that contains the potion made by every valid combination of 2 or 3 ingredients in a registry, for one set of game
+	 *			settings, perks & formula.
+	 *
+	 *			Combinations are valid when every ingredient shares an effect with at least one of the others, which is the same rule
+	 *			that RecipeSearch uses. Recipes are stored in ascending order of their sorted ingredient indices. Each recipe record
+	 *			holds its ingredient IDs, its potion's name ID, and the range of its effect records; each effect record holds an
+	 *			effect ID and the effect's final magnitude & duration. For each effect ID there is also a secondary index of every
+	 *			recipe that produces it, sorted by magnitude, so that reverse lookups are a binary search.
+	 *
+	 *			The file is opened with a MappedFile and read in place, so opening it is fast regardless of its size. It records the
+	 *			size & last write time of the registry file and a hash of the settings it was built with, so that callers can detect
+	 *			when it's out of date with IsCurrent. The file uses the native byte order, and is rejected on machines with another.
+	 */
+	class RecipeDatabase {
+	public:
+		/// @brief	Incremented whenever the file's format changes.
+		static constexpr std::uint32_t CurrentVersion{ 1 };
+		/// @brief	The ingredient ID used for the unused slots of recipes with fewer than MaxIngredients ingredients.
+		static constexpr std::uint32_t NoIngredient{ std::numeric_limits<std::uint32_t>::max() };
+		static constexpr std::size_t MaxIngredients{ 3 };
+
+	#pragma region Records
+		/// @brief	A range of characters in the string section.
+		struct StringRef {
+			std::uint32_t offset;
+			std::uint32_t length;
+		};
+		struct KeywordRecord {
+			StringRef name;
+			StringRef formID;
+			std::uint32_t disposition;
+		};
+		struct EffectRecord {
+			StringRef name;
+			/// @brief	The range of this effect's keyword IDs in the effect keywords section.
+			std::uint32_t firstKeyword;
+			std::uint32_t keywordCount;
+		};
+		struct RecipeRecord {
+			/// @brief	The ingredient IDs in ascending order, followed by NoIngredient for each unused slot.
+			std::array<std::uint32_t, MaxIngredients> ingredients;
+			/// @brief	The ID of the potion's name.
+			std::uint32_t name;
+			/// @brief	The range of the potion's effects in the recipe effects section.
+			std::uint32_t firstEffect;
+			std::uint32_t effectCount;
+		};
+		/// @brief	One effect of a finished potion.
+		struct RecipeEffect {
+			std::uint32_t effect;
+			float magnitude;
+			std::uint32_t duration;
+		};
+		/// @brief	One recipe in an effect's secondary index.
+		struct IndexEntry {
+			std::uint32_t recipe;
+			/// @brief	The magnitude of the effect in the recipe's potion.
+			float magnitude;
+		};
+	#pragma endregion Records
+
+		/// @brief	Identifies the registry file & settings that a database was built from.
+		struct Stamp {
+			std::uint64_t registrySize{ 0 };
+			std::int64_t registryTime{ 0 };
+			std::uint64_t settingsHash{ 0 };
+
+			friend constexpr bool operator==(Stamp const&, Stamp const&) noexcept = default;
+		};
+
+	private:
+		/// @brief	The byte range of one section of the file.
+		struct Section {
+			std::uint64_t offset;
+			std::uint64_t size;
+		};
+		struct Header {
+			std::array<char, 8> magic;
+			std::uint32_t version;
+			/// @brief	Always ByteOrderMark when written; a different value means the file was written with another byte order.
+			std::uint32_t byteOrder;
+			Stamp stamp;
+			Section strings, ingredients, keywords, effects, effectKeywords, names, recipes, recipeEffects, indexOffsets, index;
+		};
+		static constexpr std::array<char, 8> Magic{ 'A', 'L', 'C', 'H', 'R', 'D', 'B', '\0' };
+		static constexpr std::uint32_t ByteOrderMark{ 0x01020304 };
+		/// @brief	Every section begins at a multiple of this, so that its records are aligned.
+		static constexpr std::size_t SectionAlignment{ 8 };
+
+		MappedFile file;
+		Header header{};
+		std::span<const char> strings;
+		std::span<const StringRef> ingredients, names;
+		std::span<const KeywordRecord> keywords;
+		std::span<const EffectRecord> effects;
+		std::span<const std::uint32_t> effectKeywords;
+		std::span<const RecipeRecord> recipes;
+		std::span<const RecipeEffect> recipeEffects;
+		/// @brief	The range of each effect's entries in index. Has one more element than there are effects.
+		std::span<const std::uint64_t> indexOffsets;
+		std::span<const IndexEntry> index;
+
+		template<typename T>
+		std::span<const T> get_section(Section const& section, std::string_view const sectionName) const
+		{
+			const auto bytes{ file.bytes() };
+			if (section.offset % alignof(T) != 0 || section.size % sizeof(T) != 0 || section.offset > bytes.size() || section.size > bytes.size() - section.offset)
+				throw make_exception("The ", sectionName, " section of the recipe database is corrupted!");
+			return { reinterpret_cast<T const*>(bytes.data() + section.offset), $c(std::size_t, section.size / sizeof(T)) };
+		}
+
+		std::string_view get_string(StringRef const& ref) const
+		{
+			if (ref.offset > strings.size() || ref.length > strings.size() - ref.offset)
+				throw make_exception("A string in the recipe database is out of range!");
+			return { strings.data() + ref.offset, ref.length };
+		}
+
+		static std::int64_t get_file_time(std::filesystem::path const& path)
+		{
+			return $c(std::int64_t, std::filesystem::last_write_time(path).time_since_epoch().count());
+		}
+
+	public:
+		/**
+		 * @brief		Opens & maps a recipe database file.
+		 * @param path	The path of a file written by Build.
+		 * @throws		ex::except when the file can't be mapped, or isn't a recipe database of the current version.
+		 */
+		RecipeDatabase(std::filesystem::path const& path) : file{ path }
+		{
+			const auto bytes{ file.bytes() };
+			if (bytes.size() < sizeof(Header))
+				throw make_exception(path, " isn't a recipe database!");
+			std::memcpy(&header, bytes.data(), sizeof(Header));
+			if (header.magic != Magic)
+				throw make_exception(path, " isn't a recipe database!");
+			if (header.byteOrder != ByteOrderMark)
+				throw make_exception("Recipe database ", path, " was built on a machine with a different byte order!");
+			if (header.version != CurrentVersion)
+				throw make_exception("Recipe database ", path, " has version ", header.version, ", but version ", CurrentVersion, " is required!");
+
+			strings = get_section<char>(header.strings, "strings");
+			ingredients = get_section<StringRef>(header.ingredients, "ingredients");
+			keywords = get_section<KeywordRecord>(header.keywords, "keywords");
+			effects = get_section<EffectRecord>(header.effects, "effects");
+			effectKeywords = get_section<std::uint32_t>(header.effectKeywords, "effect keywords");
+			names = get_section<StringRef>(header.names, "potion names");
+			recipes = get_section<RecipeRecord>(header.recipes, "recipes");
+			recipeEffects = get_section<RecipeEffect>(header.recipeEffects, "recipe effects");
+			indexOffsets = get_section<std::uint64_t>(header.indexOffsets, "index offsets");
+			index = get_section<IndexEntry>(header.index, "index");
+			if (indexOffsets.size() != effects.size() + 1 || indexOffsets.back() != index.size())
+				throw make_exception("The index of recipe database ", path, " is corrupted!");
+		}
+
+	#pragma region Stamp
+		/// @brief	FNV-1a hash of the given bytes, which is used to identify the settings a database was built with.
+		static constexpr std::uint64_t Hash(std::string_view const bytes) noexcept
+		{
+			std::uint64_t hash{ 0xcbf29ce484222325ull };
+			for (const char c : bytes) {
+				hash ^= $c(std::uint8_t, c);
+				hash *= 0x100000001b3ull;
+			}
+			return hash;
+		}
+		/**
+		 * @brief				Gets the stamp of the given registry file & settings.
+		 * @param registryPath	The path of the registry file.
+		 * @param settings		Any serialization of the game settings, perks & formula; only its hash is stored.
+		 */
+		static Stamp MakeStamp(std::filesystem::path const& registryPath, std::string_view const settings)
+		{
+			return{ std::filesystem::file_size(registryPath), get_file_time(registryPath), Hash(settings) };
+		}
+
+		Stamp const& GetStamp() const noexcept { return header.stamp; }
+		/// @brief	Checks whether this database was built from the given registry file & settings, as they are now.
+		bool IsCurrent(std::filesystem::path const& registryPath, std::string_view const settings) const
+		{
+			std::error_code ec;
+			return std::filesystem::is_regular_file(registryPath, ec) && MakeStamp(registryPath, settings) == header.stamp;
+		}
+	#pragma endregion Stamp
+
+	#pragma region Accessors
+		/// @brief	Gets the number of recipes.
+		std::size_t size() const noexcept { return recipes.size(); }
+		bool empty() const noexcept { return recipes.empty(); }
+
+		std::size_t GetIngredientCount() const noexcept { return ingredients.size(); }
+		std::size_t GetEffectCount() const noexcept { return effects.size(); }
+
+		RecipeRecord const& GetRecipe(std::size_t const recipe) const
+		{
+			if (recipe >= recipes.size())
+				throw make_exception("Recipe ", recipe, " is out of range! (There are ", recipes.size(), " recipes)");
+			return recipes[recipe];
+		}
+		/// @brief	Gets the IDs of a recipe's ingredients, which are their indices in the registry the database was built from.
+		std::span<const std::uint32_t> GetIngredients(std::size_t const recipe) const
+		{
+			const auto& ids{ GetRecipe(recipe).ingredients };
+			return { ids.data(), ids[MaxIngredients - 1] == NoIngredient ? MaxIngredients - 1 : MaxIngredients };
+		}
+		std::string_view GetIngredientName(std::uint32_t const ingredient) const
+		{
+			if (ingredient >= ingredients.size())
+				throw make_exception("Ingredient ", ingredient, " is out of range! (There are ", ingredients.size(), " ingredients)");
+			return get_string(ingredients[ingredient]);
+		}
+		std::string_view GetPotionName(std::size_t const recipe) const
+		{
+			const auto& name{ GetRecipe(recipe).name };
+			if (name >= names.size())
+				throw make_exception("The name of recipe ", recipe, " is out of range!");
+			return get_string(names[name]);
+		}
+		/// @brief	Gets the effects of a recipe's potion, in the same order as the potion built from it.
+		std::span<const RecipeEffect> GetEffects(std::size_t const recipe) const
+		{
+			const auto& record{ GetRecipe(recipe) };
+			if (record.firstEffect > recipeEffects.size() || record.effectCount > recipeEffects.size() - record.firstEffect)
+				throw make_exception("The effects of recipe ", recipe, " are out of range!");
+			return recipeEffects.subspan(record.firstEffect, record.effectCount);
+		}
+		std::string_view GetEffectName(std::uint32_t const effect) const
+		{
+			if (effect >= effects.size())
+				throw make_exception("Effect ", effect, " is out of range! (There are ", effects.size(), " effects)");
+			return get_string(effects[effect].name);
+		}
+		/// @brief	Creates a copy of one of a potion's effects, including its keywords.
+		Effect GetEffect(RecipeEffect const& recipeEffect) const
+		{
+			const auto name{ GetEffectName(recipeEffect.effect) };
+			const auto& record{ effects[recipeEffect.effect] };
+			if (record.firstKeyword > effectKeywords.size() || record.keywordCount > effectKeywords.size() - record.firstKeyword)
+				throw make_exception("The keywords of effect \"", name, "\" are out of range!");
+
+			std::vector<Keyword> effectKeywordList;
+			effectKeywordList.reserve(record.keywordCount);
+			for (const auto id : effectKeywords.subspan(record.firstKeyword, record.keywordCount)) {
+				if (id >= keywords.size())
+					throw make_exception("Keyword ", id, " is out of range! (There are ", keywords.size(), " keywords)");
+				const auto& keyword{ keywords[id] };
+				effectKeywordList.emplace_back(std::string{ get_string(keyword.name) }, std::string{ get_string(keyword.formID) }, $c(EKeywordDisposition, keyword.disposition));
+			}
+			return{ std::string{ name }, recipeEffect.magnitude, recipeEffect.duration, effectKeywordList };
+		}
+		/// @brief	Gets every recipe that produces the given effect ID, strongest first. Recipes with equal magnitudes are in recipe order.
+		std::span<const IndexEntry> GetRecipesWith(std::uint32_t const effect) const
+		{
+			if (effect >= effects.size())
+				throw make_exception("Effect ", effect, " is out of range! (There are ", effects.size(), " effects)");
+			const auto begin{ indexOffsets[effect] }, end{ indexOffsets[effect + 1] };
+			if (begin > end || end > index.size())
+				throw make_exception("The index of effect ", effect, " is out of range!");
+			return index.subspan($c(std::size_t, begin), $c(std::size_t, end - begin));
+		}
+	#pragma endregion Accessors
+
+		/**
+		 * @brief				Finds every recipe whose potion has an effect matching the given name, with at least the given magnitude.
+		 *						The results are the same as RecipeSearch::FindProducing with the settings that the database was built with.
+		 * @param effectName	The name of the effect.
+		 * @param exact			When true, effect names must equal effectName; otherwise they must contain it. Case is always ignored.
+		 * @param minMagnitude	The minimum magnitude of the effect.
+		 * @returns				The matching recipes, strongest first. When several effects match, each recipe's magnitude is the largest of them.
+		 */
+		std::vector<IndexEntry> FindProducing(std::string_view const effectName, bool const exact, float const minMagnitude) const
+		{
+			std::vector<IndexEntry> matches;
+			for (std::uint32_t effect{ 0 }; effect < effects.size(); ++effect) {
+				if (!ci::matches(GetEffectName(effect), effectName, exact))
+					continue;
+				const auto entries{ GetRecipesWith(effect) };
+				const auto end{ std::partition_point(entries.begin(), entries.end(), [&minMagnitude](IndexEntry const& entry) { return entry.magnitude >= minMagnitude; }) };
+				matches.insert(matches.end(), entries.begin(), end);
+			}
+
+			// a recipe may produce several matching effects; keep only the strongest of them
+			std::sort(matches.begin(), matches.end(), [](auto&& l, auto&& r) { return l.recipe < r.recipe || (l.recipe == r.recipe && l.magnitude > r.magnitude); });
+			matches.erase(std::unique(matches.begin(), matches.end(), [](auto&& l, auto&& r) { return l.recipe == r.recipe; }), matches.end());
+			std::stable_sort(matches.begin(), matches.end(), [](auto&& l, auto&& r) { return l.magnitude > r.magnitude; });
+			return matches;
+		}
+
+	#pragma region Build
+	private:
+		/// @brief	Collects the contents of each section while a database is built.
+		struct Builder {
+			std::string strings;
+			std::vector<StringRef> ingredients, names;
+			std::vector<KeywordRecord> keywords;
+			std::vector<EffectRecord> effects;
+			std::vector<std::uint32_t> effectKeywords;
+			std::vector<RecipeRecord> recipes;
+			std::vector<RecipeEffect> recipeEffects;
+			std::vector<std::uint64_t> indexOffsets;
+			std::vector<IndexEntry> index;
+
+			std::unordered_map<std::string, std::uint32_t> keywordIDs, effectIDs, nameIDs;
+
+			StringRef add_string(std::string_view const s)
+			{
+				const StringRef ref{ $c(std::uint32_t, strings.size()), $c(std::uint32_t, s.size()) };
+				strings += s;
+				return ref;
+			}
+			std::uint32_t add_keyword(Keyword const& keyword)
+			{
+				const auto [it, inserted] { keywordIDs.try_emplace(keyword.formID + '\0' + keyword.name, $c(std::uint32_t, keywords.size())) };
+				if (inserted)
+					keywords.emplace_back(KeywordRecord{ add_string(keyword.name), add_string(keyword.formID), $c(std::uint32_t, keyword.disposition) });
+				return it->second;
+			}
+			/// @brief	Adds an effect the first time its name is seen. Like EffectTable, effects with the same name share an ID.
+			void add_effect(Effect const& effect)
+			{
+				if (effectIDs.contains(effect.name))
+					return;
+				effectIDs.emplace(effect.name, $c(std::uint32_t, effects.size()));
+				EffectRecord record{ add_string(effect.name), $c(std::uint32_t, effectKeywords.size()), $c(std::uint32_t, effect.keywords.size()) };
+				for (const auto& keyword : effect.keywords)
+					effectKeywords.emplace_back(add_keyword(keyword));
+				effects.emplace_back(record);
+			}
+			void add_recipe(std::span<const std::size_t> const indices, Potion const& potion)
+			{
+				RecipeRecord record{};
+				record.ingredients.fill(NoIngredient);
+				for (std::size_t i{ 0 }; i < indices.size(); ++i)
+					record.ingredients[i] = $c(std::uint32_t, indices[i]);
+
+				const auto [it, inserted] { nameIDs.try_emplace(potion.name, $c(std::uint32_t, names.size())) };
+				if (inserted)
+					names.emplace_back(add_string(potion.name));
+				record.name = it->second;
+
+				record.firstEffect = $c(std::uint32_t, recipeEffects.size());
+				record.effectCount = $c(std::uint32_t, potion.effects.size());
+				for (const auto& effect : potion.effects) {
+					const auto id{ effectIDs.find(effect.name) };
+					if (id == effectIDs.end())
+						throw make_exception("Potion \"", potion.name, "\" has effect \"", effect.name, "\", which isn't in the registry!");
+					recipeEffects.emplace_back(RecipeEffect{ id->second, effect.magnitude, effect.duration });
+				}
+				recipes.emplace_back(record);
+			}
+			void build_index()
+			{
+				std::vector<std::vector<IndexEntry>> entries(effects.size());
+				for (std::uint32_t recipe{ 0 }; recipe < recipes.size(); ++recipe) {
+					const auto& record{ recipes[recipe] };
+					for (std::size_t i{ record.firstEffect }; i < record.firstEffect + record.effectCount; ++i)
+						entries[recipeEffects[i].effect].emplace_back(IndexEntry{ recipe, recipeEffects[i].magnitude });
+				}
+				indexOffsets.reserve(effects.size() + 1);
+				for (auto& list : entries) {
+					std::stable_sort(list.begin(), list.end(), [](auto&& l, auto&& r) { return l.magnitude > r.magnitude; });
+					indexOffsets.emplace_back($c(std::uint64_t, index.size()));
+					index.insert(index.end(), list.begin(), list.end());
+				}
+				indexOffsets.emplace_back($c(std::uint64_t, index.size()));
+			}
+		};
+
+		template<typename T>
+		static Section write_section(std::ofstream& os, std::uint64_t& offset, T const& container)
+		{
+			using value_type = typename T::value_type;
+			static_assert(std::is_trivially_copyable_v<value_type>, "Sections can only contain trivially copyable records!");
+			static_assert(alignof(value_type) <= SectionAlignment);
+
+			// pad the previous section so that this one is aligned
+			const auto padding{ (SectionAlignment - offset % SectionAlignment) % SectionAlignment };
+			constexpr std::array<char, SectionAlignment> zeroes{};
+			os.write(zeroes.data(), $c(std::streamsize, padding));
+			offset += padding;
+
+			const Section section{ offset, $c(std::uint64_t, container.size() * sizeof(value_type)) };
+			os.write(reinterpret_cast<char const*>(container.data()), $c(std::streamsize, section.size));
+			offset += section.size;
+			return section;
+		}
+
+	public:
+		/**
+		 * @brief			Builds the potion of every valid combination of ingredients in a registry, and writes a recipe database file.
+		 * @param path		The path of the file to write.
+		 * @param registry	The registry to build recipes from.
+		 * @param builder	The builder used to make each potion.
+		 * @param perks		The perks applied to each potion.
+		 * @param stamp		The stamp of the registry file & settings, as returned by MakeStamp.
+		 * @returns			The number of recipes that were written.
+		 * @throws			ex::except when the file can't be written.
+		 */
+		static std::size_t Build(std::filesystem::path const& path, Registry const& registry, PotionBuilder const& builder, std::vector<Perk> const& perks, Stamp const& stamp)
+		{
+			Builder b;
+			b.ingredients.reserve(registry.size());
+			for (const auto& ingredient : registry.Ingredients) {
+				b.ingredients.emplace_back(b.add_string(ingredient.name));
+				for (const auto& effect : ingredient.effects)
+					b.add_effect(effect);
+			}
+
+			const auto add{ [&](std::span<const std::size_t> const indices) {
+				if (const auto potion{ builder.Build(registry, indices, perks) }; !potion.effects.empty())
+					b.add_recipe(indices, potion);
+			} };
+
+			// every ingredient must share an effect with at least one of the others; combinations are added in lexicographic order
+			const auto& matrix{ registry.GetPairMatrix() };
+			const auto n{ registry.size() };
+			for (std::size_t i{ 0 }; i < n; ++i) {
+				for (std::size_t j{ i + 1 }; j < n; ++j) {
+					const bool ij{ matrix.Combines(i, j) };
+					if (ij)
+						add(std::array{ i, j });
+					for (std::size_t k{ j + 1 }; k < n; ++k) {
+						const bool ik{ matrix.Combines(i, k) }, jk{ matrix.Combines(j, k) };
+						if ((ij || ik) && (ij || jk) && (ik || jk))
+							add(std::array{ i, j, k });
+					}
+				}
+			}
+			b.build_index();
+
+			std::ofstream os{ path, std::ios::binary | std::ios::trunc };
+			if (!os.is_open())
+				throw make_exception("Couldn't open ", path, " for writing!");
+
+			// the header is written twice; first to reserve its space, then again once the sections' offsets are known
+			Header header{};
+			header.magic = Magic;
+			header.version = CurrentVersion;
+			header.byteOrder = ByteOrderMark;
+			header.stamp = stamp;
+			os.write(reinterpret_cast<char const*>(&header), sizeof(Header));
+
+			std::uint64_t offset{ sizeof(Header) };
+			header.strings = write_section(os, offset, b.strings);
+			header.ingredients = write_section(os, offset, b.ingredients);
+			header.keywords = write_section(os, offset, b.keywords);
+			header.effects = write_section(os, offset, b.effects);
+			header.effectKeywords = write_section(os, offset, b.effectKeywords);
+			header.names = write_section(os, offset, b.names);
+			header.recipes = write_section(os, offset, b.recipes);
+			header.recipeEffects = write_section(os, offset, b.recipeEffects);
+			header.indexOffsets = write_section(os, offset, b.indexOffsets);
+			header.index = write_section(os, offset, b.index);
+
+			os.seekp(0);
+			os.write(reinterpret_cast<char const*>(&header), sizeof(Header));
+			if (!os.flush())
+				throw make_exception("Failed to write recipe database ", path, "!");
+			return b.recipes.size();
+		}
+	#pragma endregion Build
+	};
+}
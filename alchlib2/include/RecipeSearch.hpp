@@ -0,0 +1,303 @@
+#pragma once
+/**
+ * @file	RecipeSearch.hpp
+ * @author	radj307
+ * @brief	Time-bounded, cancellable search for the ingredient combination that produces the best potion.
+ */
+#include "PotionBuilder.hpp"
+
+#include <make_exception.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+namespace alchlib2 {
+	/**
+	 * @brief	Searches the ingredient combinations in a registry for the one that produces the highest-scoring potion.
+	 *
+	 *			Every pair of candidates is tried before any triple, so a good result is usually found early. Only combinations in
+	 *			which every ingredient shares an effect with at least one of the others are tried, since any other ingredient would
+	 *			be wasted; the registry's PairMatrix is used to skip the rest without building their potions.
+	 *
+	 *			The search stops early when the deadline passes or when a stop is requested, and returns the best result found so far.
+	 */
+	class RecipeSearch {
+	public:
+		/// @brief	The maximum number of ingredients in a potion.
+		static constexpr std::size_t MaxIngredients{ 3 };
+		/// @brief	The number of combinations that are tried between each check of the deadline & stop token.
+		static constexpr std::size_t CheckInterval{ 64 };
+
+		struct Recipe {
+			/// @brief	The indices of the ingredients in the registry, in ascending order.
+			std::vector<std::size_t> ingredients;
+			Potion potion;
+			double score;
+		};
+
+		enum class EStopReason : std::uint8_t {
+			/// @brief	Every combination was tried, so the result is the best one.
+			Exhausted,
+			/// @brief	The deadline passed before every combination was tried.
+			Deadline,
+			/// @brief	A stop was requested before every combination was tried.
+			Cancelled,
+		};
+
+		struct Result {
+			/// @brief	The highest-scoring recipe found, or std::nullopt when no combination was accepted by the score function.
+			std::optional<Recipe> best;
+			EStopReason stopReason{ EStopReason::Exhausted };
+			/// @brief	The number of potions that were built & scored.
+			std::size_t evaluated{ 0 };
+
+			/// @brief	Checks whether every combination was tried, which means that best is the best possible result.
+			bool is_exhaustive() const noexcept { return stopReason == EStopReason::Exhausted; }
+		};
+
+		/// @brief	Scores a potion. Higher scores are better; std::nullopt rejects the potion.
+		using score_function = std::function<std::optional<double>(Potion const&)>;
+		/// @brief	Called with each recipe that scores higher than every recipe before it.
+		using improvement_callback = std::function<void(Recipe const&)>;
+
+		struct Options {
+			/// @brief	The indices of the ingredients to combine. When empty, every ingredient in the registry is a candidate.
+			std::vector<std::size_t> candidates;
+			/// @brief	The maximum number of ingredients in each combination. Must be 2 or 3.
+			std::size_t maxIngredients{ MaxIngredients };
+			/// @brief	When set, the search stops once this time has passed.
+			std::optional<std::chrono::steady_clock::time_point> deadline;
+			/// @brief	The search stops when a stop is requested on this token.
+			std::stop_token stopToken;
+			improvement_callback onImprovement;
+		};
+
+	private:
+		Registry const& registry;
+		PotionBuilder const& builder;
+		std::vector<Perk> const& perks;
+
+	public:
+		/**
+		 * @param registry	The registry to search. It must outlive this object.
+		 * @param builder	The builder used to make each potion. It must outlive this object.
+		 * @param perks		The perks applied to each potion. They must outlive this object.
+		 */
+		RecipeSearch(Registry const& registry, PotionBuilder const& builder, std::vector<Perk> const& perks) : registry{ registry }, builder{ builder }, perks{ perks } {}
+
+		/**
+		 * @brief			Searches for the highest-scoring combination. When several combinations have the same score, the first one found is kept.
+		 * @param score		The score function.
+		 * @param options	The candidates, limits & callback to use.
+		 * @returns			The best recipe found, and why the search stopped.
+		 */
+		Result Run(score_function const& score, Options const& options) const
+		{
+			if (options.maxIngredients < 2 || options.maxIngredients > MaxIngredients)
+				throw make_exception("Recipes must have between 2 and ", MaxIngredients, " ingredients! (Got ", options.maxIngredients, ')');
+
+			std::vector<std::size_t> candidates{ options.candidates };
+			if (candidates.empty()) {
+				candidates.resize(registry.size());
+				for (std::size_t i{ 0 }; i < candidates.size(); ++i)
+					candidates[i] = i;
+			}
+			std::sort(candidates.begin(), candidates.end());
+			candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+			const auto& matrix{ registry.GetPairMatrix() };
+			Result result;
+			std::size_t untilCheck{ 0 };
+
+			// returns false when the search should stop
+			const auto should_continue{ [&] {
+				if (untilCheck-- != 0)
+					return true;
+				untilCheck = CheckInterval - 1;
+				if (options.stopToken.stop_requested())
+					result.stopReason = EStopReason::Cancelled;
+				else if (options.deadline.has_value() && std::chrono::steady_clock::now() >= options.deadline.value())
+					result.stopReason = EStopReason::Deadline;
+				else
+					return true;
+				return false;
+			} };
+			const auto evaluate{ [&](std::span<const std::size_t> const indices) {
+				auto potion{ builder.Build(registry, indices, perks) };
+				++result.evaluated;
+				if (const auto s{ score(potion) }; s.has_value() && (!result.best.has_value() || s.value() > result.best->score)) {
+					result.best = Recipe{ { indices.begin(), indices.end() }, std::move(potion), s.value() };
+					if (options.onImprovement)
+						options.onImprovement(result.best.value());
+				}
+			} };
+
+			const auto n{ candidates.size() };
+			for (std::size_t i{ 0 }; i < n; ++i) {
+				for (std::size_t j{ i + 1 }; j < n; ++j) {
+					if (!should_continue())
+						return result;
+					if (matrix.Combines(candidates[i], candidates[j]))
+						evaluate(std::array{ candidates[i], candidates[j] });
+				}
+			}
+			if (options.maxIngredients < 3)
+				return result;
+
+			for (std::size_t i{ 0 }; i < n; ++i) {
+				for (std::size_t j{ i + 1 }; j < n; ++j) {
+					const auto a{ candidates[i] }, b{ candidates[j] };
+					const bool ab{ matrix.Combines(a, b) };
+					for (std::size_t k{ j + 1 }; k < n; ++k) {
+						if (!should_continue())
+							return result;
+						const auto c{ candidates[k] };
+						const bool ac{ matrix.Combines(a, c) }, bc{ matrix.Combines(b, c) };
+						// every ingredient must share an effect with at least one of the others
+						if ((ab || ac) && (ab || bc) && (ac || bc))
+							evaluate(std::array{ a, b, c });
+					}
+				}
+			}
+			return result;
+		}
+		/// @brief	Searches every combination of every ingredient in the registry, without a deadline.
+		Result Run(score_function const& score) const { return Run(score, Options{}); }
+
+	#pragma region FindProducing
+		struct ProducingResult {
+			/// @brief	Every recipe that produces the effect, strongest first. Each recipe's score is the magnitude of the effect.
+			std::vector<Recipe> recipes;
+			/// @brief	The number of potions that were built, including those that didn't reach the minimum magnitude.
+			std::size_t evaluated{ 0 };
+		};
+
+	private:
+		/**
+		 * @brief	Gets the largest factor that the perks could multiply an effect's magnitude by.
+		 *			Each perk is applied to probe potions that satisfy the conditions of the vanilla perks (beneficial, restore & harmful
+		 *			effects), and the largest change to any probe effect is used. The factors of each perk are multiplied together, so
+		 *			the result is an upper bound even when the conditions of several perks can't be met at the same time.
+		 */
+		static float get_perk_bound(std::vector<Perk> const& perks)
+		{
+			const std::vector<std::vector<Effect>> probes{
+				{ Effect{ "Probe", 100.0f, 0, { keywords::MagicAlchBeneficial, keywords::MagicAlchRestoreHealth, keywords::MagicAlchRestoreStamina, keywords::MagicAlchRestoreMagicka } } },
+				{ Effect{ "Probe", 100.0f, 0, { keywords::MagicAlchBeneficial } }, Effect{ "Probe 2", 50.0f, 0, { keywords::MagicAlchHarmful } } },
+				{ Effect{ "Probe", 100.0f, 0, { keywords::MagicAlchHarmful } }, Effect{ "Probe 2", 50.0f, 0, { keywords::MagicAlchBeneficial, keywords::MagicAlchRestoreHealth } } },
+				{ Effect{ "Probe", 100.0f, 0, { keywords::MagicAlchHarmful } } },
+			};
+
+			float bound{ 1.0f };
+			for (const auto& perk : perks) {
+				float factor{ 0.0f };
+				for (const auto& probe : probes) {
+					auto effects{ probe };
+					for (auto& effect : effects)
+						perk.ApplyToEffect(effect);
+					Potion potion{ "Probe", std::move(effects) };
+					perk.ApplyToPotion(potion);
+
+					for (const auto& effect : potion.effects) {
+						const auto original{ std::find_if(probe.begin(), probe.end(), [&effect](auto&& it) { return it.name == effect.name; }) };
+						if (original != probe.end())
+							factor = std::max(factor, effect.magnitude / original->magnitude);
+					}
+				}
+				bound *= factor;
+			}
+			return bound;
+		}
+
+	public:
+		/**
+		 * @brief				Finds every combination of ingredients whose potion has an effect matching the given name, with at least the given magnitude.
+		 *
+		 *						A potion only has an effect when at least two of its ingredients have it, and its magnitude comes from the
+		 *						strongest of them. The largest magnitude that each ingredient's effect could reach is bounded using the
+		 *						alchemy formula & perks, so only combinations that contain an ingredient that could reach the minimum are
+		 *						built. Only combinations in which every ingredient shares an effect with another are included.
+		 * @param effectName	The name of the effect.
+		 * @param exact			When true, effect names must equal effectName; otherwise they must contain it. Case is always ignored.
+		 * @param minMagnitude	The minimum magnitude of the effect in the finished potion.
+		 * @param maxIngredients The maximum number of ingredients in each combination. Must be 2 or 3.
+		 */
+		ProducingResult FindProducing(std::string const& effectName, bool const exact, float const minMagnitude, std::size_t const maxIngredients = MaxIngredients) const
+		{
+			if (maxIngredients < 2 || maxIngredients > MaxIngredients)
+				throw make_exception("Recipes must have between 2 and ", MaxIngredients, " ingredients! (Got ", maxIngredients, ')');
+
+			struct Holder {
+				std::size_t ingredient;
+				/// @brief	The largest magnitude that the effect could have in a potion made with this ingredient.
+				float bound;
+			};
+			// a small margin keeps rounding differences between the bound & the built potion from excluding a recipe
+			const float perkBound{ get_perk_bound(perks) * 1.0001f };
+
+			// the ingredients that have each matching effect
+			std::map<std::string, std::vector<Holder>> holders;
+			for (std::size_t i{ 0 }; i < registry.size(); ++i) {
+				for (const auto& effect : registry.Ingredients[i].effects) {
+					if (!effect.IsSimilarTo(effectName, exact))
+						continue;
+					const float scaled{ effect.HasAnyKeyword(keywords::MagicAlchDurationBased) ? effect.magnitude : std::round(builder.coreFormula.GetResult(effect.magnitude)) };
+					auto& list{ holders[effect.name] };
+					if (!list.empty() && list.back().ingredient == i)
+						list.back().bound = std::max(list.back().bound, scaled * perkBound);
+					else
+						list.emplace_back(Holder{ i, scaled * perkBound });
+				}
+			}
+
+			// collect the combinations that could reach the minimum magnitude, as sorted index lists
+			const auto& matrix{ registry.GetPairMatrix() };
+			std::vector<std::vector<std::size_t>> combinations;
+			for (const auto& [name, list] : holders) {
+				for (std::size_t i{ 0 }; i < list.size(); ++i) {
+					for (std::size_t j{ i + 1 }; j < list.size(); ++j) {
+						if (list[i].bound < minMagnitude && list[j].bound < minMagnitude)
+							continue;
+						const auto a{ list[i].ingredient }, b{ list[j].ingredient };
+						combinations.emplace_back(std::vector<std::size_t>{ a, b });
+						if (maxIngredients < 3)
+							continue;
+						for (std::size_t c{ 0 }; c < registry.size(); ++c) {
+							if (c != a && c != b && (matrix.Combines(a, c) || matrix.Combines(b, c))) {
+								std::vector<std::size_t> triple{ a, b, c };
+								std::sort(triple.begin(), triple.end());
+								combinations.emplace_back(std::move(triple));
+							}
+						}
+					}
+				}
+			}
+			std::sort(combinations.begin(), combinations.end());
+			combinations.erase(std::unique(combinations.begin(), combinations.end()), combinations.end());
+
+			ProducingResult result;
+			for (auto& combination : combinations) {
+				auto potion{ builder.Build(registry, combination, perks) };
+				++result.evaluated;
+
+				std::optional<float> magnitude;
+				for (const auto& effect : potion.effects)
+					if (effect.IsSimilarTo(effectName, exact) && effect.magnitude >= minMagnitude && (!magnitude.has_value() || effect.magnitude > magnitude.value()))
+						magnitude = effect.magnitude;
+				if (magnitude.has_value())
+					result.recipes.emplace_back(Recipe{ std::move(combination), std::move(potion), magnitude.value() });
+			}
+			std::stable_sort(result.recipes.begin(), result.recipes.end(), [](auto&& l, auto&& r) { return l.score > r.score; });
+			return result;
+		}
+	#pragma endregion FindProducing
+	};
+}
@@ -1,10 +1,23 @@
 #pragma once
 #include "Ingredient.hpp"
+#include "SerializerDefs.h"
+#include "NameBlob.hpp"
+#include "EffectTable.hpp"
+#include "PairMatrix.hpp"
+#include "EffectIndex.hpp"
+#include "NameCompleter.hpp"
+#include "BKTree.hpp"
+#include "IngredientStream.hpp"
 
 #include <fileio.hpp>
+#include <make_exception.hpp>
 
 #include <algorithm>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
 
 namespace alchlib2 {
 	class Registry {
@@ -12,12 +25,115 @@ namespace alchlib2 {
 		using const_iterator = typename std::vector<Ingredient>::const_iterator;
 		using iterator = typename std::vector<Ingredient>::const_iterator;
 
+		/**
+		 * @brief	Lookup structures derived from Ingredients, each built on first use.
+		 *			Copies of a Registry share these until one of them is modified.
+		 */
+		struct Indexes {
+			std::once_flag nameBlobOnce;
+			NameBlob nameBlob;
+			std::once_flag effectTableOnce;
+			EffectTable effectTable;
+			std::once_flag pairMatrixOnce;
+			PairMatrix pairMatrix;
+			std::once_flag effectIndexOnce;
+			EffectIndex effectIndex;
+			std::once_flag nameCompleterOnce;
+			NameCompleter nameCompleter;
+			std::once_flag ingredientNameTreeOnce;
+			BKTree ingredientNameTree;
+		};
+		std::shared_ptr<Indexes> indexes{ std::make_shared<Indexes>() };
+
 	public:
+		/// @brief	The ingredients in this registry. If you modify this directly, call invalidate_indexes() afterwards.
 		std::vector<Ingredient> Ingredients;
 
-		CONSTEXPR Registry() = default;
-		CONSTEXPR Registry(std::vector<Ingredient>&& ingredients) : Ingredients{ std::move(ingredients) } {}
-		CONSTEXPR Registry(const std::vector<Ingredient>& ingredients) : Ingredients{ ingredients } {}
+		Registry() = default;
+		Registry(std::vector<Ingredient>&& ingredients) : Ingredients{ std::move(ingredients) } {}
+		Registry(const std::vector<Ingredient>& ingredients) : Ingredients{ ingredients } {}
+		Registry(Registry const&) = default;
+		/// @brief	Move constructor. The moved-from registry is left empty, with its own indexes, so that it's still safe to use.
+		Registry(Registry&& o) noexcept : indexes{ std::exchange(o.indexes, std::make_shared<Indexes>()) }, Ingredients{ std::move(o.Ingredients) }
+		{
+			o.Ingredients.clear();
+		}
+
+		Registry& operator=(Registry const&) = default;
+		/// @brief	Move assignment operator. The moved-from registry is left empty, with its own indexes, so that it's still safe to use.
+		Registry& operator=(Registry&& o) noexcept
+		{
+			if (this != &o) {
+				indexes = std::exchange(o.indexes, std::make_shared<Indexes>());
+				Ingredients = std::move(o.Ingredients);
+				o.Ingredients.clear();
+			}
+			return *this;
+		}
+
+	#pragma region Indexes
+		/// @brief	Discards all lookup structures derived from Ingredients. This must be called after modifying Ingredients directly.
+		void invalidate_indexes()
+		{
+			indexes = std::make_shared<Indexes>();
+		}
+
+		/// @brief	Gets the contiguous lowercase name buffer for this registry, building it if necessary. This is thread-safe.
+		NameBlob const& GetNameBlob() const
+		{
+			std::call_once(indexes->nameBlobOnce, [this] { indexes->nameBlob = NameBlob{ Ingredients }; });
+			return indexes->nameBlob;
+		}
+
+		/// @brief	Gets the structure-of-arrays copy of this registry's effect data, building it if necessary. This is thread-safe.
+		EffectTable const& GetEffectTable() const
+		{
+			std::call_once(indexes->effectTableOnce, [this] { indexes->effectTable = EffectTable{ Ingredients }; });
+			return indexes->effectTable;
+		}
+
+		/// @brief	Gets the matrix of which ingredient pairs share effects, building it (and the EffectTable) if necessary. This is thread-safe.
+		PairMatrix const& GetPairMatrix() const
+		{
+			std::call_once(indexes->pairMatrixOnce, [this] { indexes->pairMatrix = PairMatrix{ GetEffectTable() }; });
+			return indexes->pairMatrix;
+		}
+
+		/// @brief	Gets the index of which ingredients have each effect, building it (and the EffectTable) if necessary. This is thread-safe.
+		EffectIndex const& GetEffectIndex() const
+		{
+			std::call_once(indexes->effectIndexOnce, [this] { indexes->effectIndex = EffectIndex{ GetEffectTable() }; });
+			return indexes->effectIndex;
+		}
+
+		/// @brief	Gets the sorted index of every ingredient, effect & keyword name for prefix completion, building it if necessary. This is thread-safe.
+		NameCompleter const& GetNameCompleter() const
+		{
+			std::call_once(indexes->nameCompleterOnce, [this] { indexes->nameCompleter = NameCompleter{ Ingredients }; });
+			return indexes->nameCompleter;
+		}
+
+		/// @brief	Gets the BK-tree of this registry's ingredient names, whose values are ingredient indices, building it if necessary. This is thread-safe.
+		BKTree const& GetIngredientNameTree() const
+		{
+			std::call_once(indexes->ingredientNameTreeOnce, [this] {
+				for (std::size_t i{ 0 }; i < Ingredients.size(); ++i)
+					indexes->ingredientNameTree.insert(Ingredients[i].name, $c(std::uint32_t, i));
+			});
+			return indexes->ingredientNameTree;
+		}
+
+		/// @brief	Builds every lookup structure now instead of on first use, so that later queries never wait for one to be built.
+		void build_indexes() const
+		{
+			GetNameBlob();
+			GetEffectTable();
+			GetPairMatrix();
+			GetEffectIndex();
+			GetNameCompleter();
+			GetIngredientNameTree();
+		}
+	#pragma endregion Indexes
 
 	#pragma region VectorInterface
 		CONSTEXPR auto begin() const { return Ingredients.begin(); }
@@ -39,106 +155,130 @@ namespace alchlib2 {
 		}
 	#pragma endregion ReadFrom
 	#pragma region WriteTo
-		static bool WriteTo(std::filesystem::path const& path, const Registry& registry)
+		/**
+		 * @brief			Writes a registry to a file.
+		 * @param path		The path of the file to write.
+		 * @param registry	The registry to write.
+		 * @param version	The schema version to write. See schema::ERegistryVersion.
+		 */
+		static bool WriteTo(std::filesystem::path const& path, const Registry& registry, schema::ERegistryVersion const version = schema::CurrentRegistryVersion)
 		{
-			return file::write(path, nlohmann::json{ registry });
+			return file::write(path, schema::WriteRegistry(registry.Ingredients, version));
 		}
 	#pragma endregion WriteTo
 
-		CONSTEXPR void sort(const std::function<bool(Ingredient, Ingredient)>& comp)
+		void sort(const std::function<bool(Ingredient, Ingredient)>& comp)
 		{
 			std::sort(Ingredients.begin(), Ingredients.end(), comp);
+			invalidate_indexes();
 		}
 
-		CONSTEXPR void remove_if(const std::function<bool(Ingredient)>& pred)
+		void remove_if(const std::function<bool(Ingredient)>& pred)
 		{
 			Ingredients.erase(std::remove_if(Ingredients.begin(), Ingredients.end(), pred), Ingredients.end());
+			invalidate_indexes();
 		}
 
 		/// @brief	Inverts the result of the given predicate before passing it to remove_if.
-		CONSTEXPR void apply_inclusive_filter(const std::function<bool(Ingredient)>& pred)
+		void apply_inclusive_filter(const std::function<bool(Ingredient)>& pred)
 		{
 			remove_if([&pred](auto&& ingredient) -> bool {
 				return !pred($fwd(ingredient));
 			});
 		}
 
-		CONSTEXPR Registry copy_if(const std::function<bool(Ingredient)>& pred) const
+		Registry copy_if(const std::function<bool(Ingredient)>& pred) const
 		{
 			Registry tmp{};
 			std::copy_if(Ingredients.begin(), Ingredients.end(), std::back_inserter(tmp.Ingredients), pred);
 			return tmp;
 		}
 
-		CONSTEXPR void apply_inclusive_filter(const std::string& search_term, const bool requireExactMatch, const bool searchIngredients, const bool searchEffects = false, const bool searchKeywords = false)
+		/// @brief	Removes all ingredients that don't match the given search term. See copy_inclusive_filter.
+		void apply_inclusive_filter(std::string_view const search_term, const bool requireExactMatch, const bool searchIngredients, const bool searchEffects = false, const bool searchKeywords = false)
 		{
 			if (!searchIngredients && !searchEffects && !searchKeywords) return;
-			apply_inclusive_filter([&](auto&& ingredient) -> bool {
-				if (searchIngredients && ingredient.IsSimilarTo(search_term, requireExactMatch))
-					return true;
-				else if (searchEffects || searchKeywords) {
-					return std::any_of(ingredient.effects.begin(), ingredient.effects.end(), [&](auto&& effect) {
-						if (searchEffects && effect.IsSimilarTo(search_term, requireExactMatch))
-							return true;
-						else if (searchKeywords) {
-							return std::any_of(effect.keywords.begin(), effect.keywords.end(), [&](auto&& keyword) {
-								return keyword.IsSimilarTo(search_term, requireExactMatch);
-							});
-						}
-					});
-				}
-				return false;
-			});
+			const auto matches{ GetNameBlob().search(search_term, requireExactMatch, searchIngredients, searchEffects, searchKeywords) };
+			std::size_t i{ 0 };
+			Ingredients.erase(std::remove_if(Ingredients.begin(), Ingredients.end(), [&matches, &i](auto&&) { return !matches[i++]; }), Ingredients.end());
+			invalidate_indexes();
 		}
 
-		CONSTEXPR Registry copy_inclusive_filter(const std::string& search_term, const bool requireExactMatch, const bool searchIngredients, const bool searchEffects = false, const bool searchKeywords = false) const
+		/**
+		 * @brief					Gets a copy of this registry that only contains ingredients matching the given search term.
+		 *							Names are found with a linear scan of the registry's NameBlob.
+		 * @param search_term		The term to search for. Case is ignored.
+		 * @param requireExactMatch	When true, names must equal the search term; otherwise they must contain it.
+		 * @param searchIngredients	When true, ingredient names are searched.
+		 * @param searchEffects		When true, effect names are searched.
+		 * @param searchKeywords	When true, keyword names are searched. Keyword form IDs are also searched when requireExactMatch is false.
+		 */
+		Registry copy_inclusive_filter(std::string_view const search_term, const bool requireExactMatch, const bool searchIngredients, const bool searchEffects = false, const bool searchKeywords = false) const
 		{
 			if (!searchIngredients && !searchEffects && !searchKeywords) return {};
-			return copy_if([&](Ingredient const& ingredient) -> bool {
-				return (searchIngredients && ingredient.IsSimilarTo(search_term, requireExactMatch))
-					|| (searchEffects && ingredient.AnyEffectIsSimilarTo(search_term, requireExactMatch))
-					|| (searchKeywords && ingredient.AnyEffectKeywordIsSimilarTo(search_term, requireExactMatch));
-			});
+			const auto matches{ GetNameBlob().search(search_term, requireExactMatch, searchIngredients, searchEffects, searchKeywords) };
+			Registry tmp{};
+			tmp.Ingredients.reserve($c(std::size_t, std::count(matches.begin(), matches.end(), true)));
+			for (std::size_t i{ 0 }; i < Ingredients.size(); ++i)
+				if (matches[i])
+					tmp.Ingredients.emplace_back(Ingredients[i]);
+			return tmp;
 		}
 
-		CONSTEXPR const_iterator find_best_fit(std::string name, const bool searchIngredients = true, const bool searchEffects = true) const
+	#pragma region Streams
+		/**
+		 * @brief		Gets a lazily-evaluated stream of the ingredients that satisfy the given predicate, in registry order.
+		 *				This is the streaming equivalent of copy_if. The registry must outlive the stream, and must not be modified while it is in use.
+		 * @param pred	A callable with the signature bool(Ingredient const&).
+		 */
+		template<typename TPredicate>
+		IngredientStream<TPredicate> stream_if(TPredicate pred) const
 		{
-			std::vector<const_iterator> partialMatches;
+			return{ Ingredients, std::move(pred) };
+		}
+		/**
+		 * @brief	Gets a lazily-evaluated stream of the ingredients that match the given search term, in registry order.
+		 *			This is the streaming equivalent of copy_inclusive_filter, and yields the same ingredients.
+		 *			The registry must outlive the stream, and must not be modified while it is in use.
+		 */
+		IngredientStream<NameFilter> stream_inclusive_filter(std::string_view const search_term, const bool requireExactMatch, const bool searchIngredients, const bool searchEffects = false, const bool searchKeywords = false) const
+		{
+			return{ Ingredients, NameFilter{ std::string{ search_term }, requireExactMatch, searchIngredients, searchEffects, searchKeywords } };
+		}
+	#pragma endregion Streams
 
-			name = str::tolower(name);
+		const_iterator find_best_fit(std::string_view const name, const bool searchIngredients = true, const bool searchEffects = true) const
+		{
+			std::vector<const_iterator> partialMatches;
 
 			if (searchIngredients && searchEffects) {
 				for (auto it{ Ingredients.begin() }; it != Ingredients.end(); ++it) {
-					const auto name_lc{ str::tolower(it->name) };
-					if (name_lc == name)
+					if (ci::equals(it->name, name))
 						return it;
-					else if ((name_lc.find(name) < name_lc.size()))
+					else if (ci::contains(it->name, name))
 						partialMatches.emplace_back(it);
 					else for (auto fx{ it->effects.begin() }; fx != it->effects.end(); ++fx) {
-						const auto lc{ str::tolower(fx->name) };
-						if (lc == name)
+						if (ci::equals(fx->name, name))
 							return it;
-						else if ((lc.find(name) < lc.size()))
+						else if (ci::contains(fx->name, name))
 							partialMatches.emplace_back(it);
 					}
 				}
 			}
 			else if (searchIngredients) {
 				for (auto it{ Ingredients.begin() }; it != Ingredients.end(); ++it) {
-					const auto name_lc{ str::tolower(it->name) };
-					if (name_lc == name)
+					if (ci::equals(it->name, name))
 						return it;
-					else if ((name_lc.find(name) < name_lc.size()))
+					else if (ci::contains(it->name, name))
 						partialMatches.emplace_back(it);
 				}
 			}
 			else if (searchEffects) {
 				for (auto it{ Ingredients.begin() }; it != Ingredients.end(); ++it) {
 					for (auto fx{ it->effects.begin() }; fx != it->effects.end(); ++fx) {
-						const auto lc{ str::tolower(fx->name) };
-						if (lc == name)
+						if (ci::equals(fx->name, name))
 							return it;
-						else if ((lc.find(name) < lc.size()))
+						else if (ci::contains(fx->name, name))
 							partialMatches.emplace_back(it);
 					}
 				}
@@ -150,7 +290,52 @@ namespace alchlib2 {
 			return partialMatches.front();
 		}
 
-		CONSTEXPR Registry find_best_fit(std::vector<std::string> const& search_terms, const bool searchIngredients = true, const bool searchEffects = true) const
+		/**
+		 * @brief				Gets the default maximum edit distance used by find_similar for a name of the given length.
+		 *						This is a third of the length, but always at least 1 and at most 3, so that short names don't match everything.
+		 */
+		static constexpr std::size_t GetDefaultMaxEditDistance(std::size_t const length) noexcept
+		{
+			return std::clamp<std::size_t>(length / 3, 1, 3);
+		}
+		/**
+		 * @brief				Finds the ingredients whose names are within an edit distance of the given name, for correcting misspelled names.
+		 *						This uses the registry's BK-tree of ingredient names, so it doesn't compare the name to every ingredient.
+		 * @param name			The name to search for. Case is ignored.
+		 * @param maxDistance	The largest edit distance to include. When std::nullopt, GetDefaultMaxEditDistance is used.
+		 * @returns				The indices of the matching ingredients & their distances, closest first. Ties are in registry order.
+		 *						Ingredients that share a name are only included once, as the first of them.
+		 */
+		std::vector<BKTree::Match> find_similar(std::string_view const name, std::optional<std::size_t> const maxDistance = std::nullopt) const
+		{
+			const auto matches{ GetIngredientNameTree().find(name, maxDistance.value_or(GetDefaultMaxEditDistance(name.size()))) };
+
+			// ingredients that share a name are the same distance away, so each duplicate follows its first match in the same run of distances
+			std::vector<BKTree::Match> unique;
+			unique.reserve(matches.size());
+			std::size_t runStart{ 0 };
+			for (const auto& match : matches) {
+				if (!unique.empty() && unique.back().distance != match.distance)
+					runStart = unique.size();
+				if (std::none_of(unique.begin() + runStart, unique.end(), [&](auto&& it) { return ci::equals(Ingredients[it.value].name, Ingredients[match.value].name); }))
+					unique.emplace_back(match);
+			}
+			return unique;
+		}
+		/**
+		 * @brief		Finds the ingredient that a misspelled name most likely refers to, using find_similar with the default maximum edit distance.
+		 * @param name	The misspelled name. Case is ignored.
+		 * @returns		The ingredient whose name is closer to the given name than any other, or end() when no name is close enough or several names are equally close.
+		 */
+		const_iterator find_correction(std::string_view const name) const
+		{
+			const auto similar{ find_similar(name) };
+			if (similar.empty() || (similar.size() > 1 && similar[1].distance == similar[0].distance))
+				return end();
+			return begin() + similar.front().value;
+		}
+
+		Registry find_best_fit(std::vector<std::string> const& search_terms, const bool searchIngredients = true, const bool searchEffects = true) const
 		{
 			Registry tmp;
 			if (search_terms.empty()) return tmp;
@@ -162,7 +347,15 @@ namespace alchlib2 {
 			return tmp;
 		}
 
-		NLOHMANN_DEFINE_TYPE_INTRUSIVE(Registry, Ingredients);
+		friend void to_json(nlohmann::json& j, const Registry& registry)
+		{
+			j = schema::WriteRegistry(registry.Ingredients);
+		}
+		friend void from_json(const nlohmann::json& j, Registry& registry)
+		{
+			registry.Ingredients = schema::ReadRegistry(j);
+			registry.invalidate_indexes();
+		}
 	};
 
 }
@@ -0,0 +1,259 @@
+#pragma once
+/**
+ * @file	RegistryIndex.hpp
+ * @author	radj307
+ * @brief	Sidecar index of where each ingredient is stored in a registry file, so that individual ingredients can be read without parsing the whole file.
+ */
+#include "Registry.hpp"
+#include "SerializerDefs.h"
+
+#include <fileio.hpp>
+#include <make_exception.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace alchlib2 {
+	/**
+	 * @brief	Maps the lowercased name of each ingredient in a registry file to the byte range of its JSON object in that file.
+	 *			The index is saved next to the registry file, and records the registry file's size & last write time so that it can be
+	 *			discarded when the registry changes.
+	 */
+	class RegistryIndex {
+	public:
+		/// @brief	Incremented whenever the index file's format changes.
+		static constexpr unsigned CurrentVersion{ 2 };
+
+		/// @brief	A byte range in the registry file.
+		struct Range {
+			std::uint64_t offset{ 0 };
+			std::uint64_t length{ 0 };
+
+			NLOHMANN_DEFINE_TYPE_INTRUSIVE(Range, offset, length);
+		};
+		struct Entry : Range {
+			/// @brief	The lowercased ingredient name.
+			std::string name;
+
+			NLOHMANN_DEFINE_TYPE_INTRUSIVE(Entry, name, offset, length);
+		};
+
+		unsigned Version{ CurrentVersion };
+		/// @brief	The size of the registry file when the index was generated.
+		std::uintmax_t FileSize{ 0 };
+		/// @brief	The last write time of the registry file when the index was generated, in file clock ticks.
+		std::int64_t FileTime{ 0 };
+		/// @brief	The schema version of the registry file.
+		schema::ERegistryVersion SchemaVersion{ schema::ERegistryVersion::Inline };
+		/// @brief	The "Keywords" & "Effects" tables of normalized registries, which are needed to read any ingredient.
+		Range KeywordTable, EffectTable;
+		/// @brief	One entry per ingredient, in registry order.
+		std::vector<Entry> Entries;
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE(RegistryIndex, Version, FileSize, FileTime, SchemaVersion, KeywordTable, EffectTable, Entries);
+
+	private:
+		static std::int64_t get_file_time(std::filesystem::path const& path)
+		{
+			return $c(std::int64_t, std::filesystem::last_write_time(path).time_since_epoch().count());
+		}
+
+		/// @brief	The locations of the parts of a registry file.
+		struct Layout {
+			unsigned version{ $c(unsigned, schema::ERegistryVersion::Inline) };
+			Range keywords, effects;
+			std::vector<Range> ingredients;
+		};
+
+		/**
+		 * @brief		Finds the top-level "Version" field, the "Keywords" & "Effects" arrays, and the byte range of each element of the
+		 *				"Ingredients" array in a registry file's contents, without parsing any of the elements.
+		 * @param json	The contents of a registry file.
+		 */
+		static Layout scan_layout(std::string_view const json)
+		{
+			Layout layout;
+			std::size_t depth{ 0 }, begin{ 0 };
+			std::string_view lastKey;
+			bool inIngredients{ false }, foundIngredients{ false };
+
+			for (std::size_t i{ 0 }; i < json.size(); ++i) {
+				const char c{ json[i] };
+				switch (c) {
+				case '"': {
+					const auto strBegin{ i + 1 };
+					for (++i; i < json.size() && json[i] != '"'; ++i)
+						if (json[i] == '\\') ++i; //< skip escaped characters
+					if (depth == 1)
+						lastKey = json.substr(strBegin, i - strBegin);
+					break;
+				}
+				case '{':
+				case '[':
+					if (depth == 1 || (inIngredients && depth == 2 && c == '{'))
+						begin = i;
+					if (depth == 1 && c == '[' && lastKey == "Ingredients")
+						inIngredients = foundIngredients = true;
+					++depth;
+					break;
+				case '}':
+				case ']': {
+					if (depth == 0)
+						throw make_exception("Unexpected '", c, "' at offset ", i, " in registry file!");
+					--depth;
+					const Range range{ begin, i + 1 - begin };
+					if (inIngredients && depth == 2 && c == '}')
+						layout.ingredients.emplace_back(range);
+					else if (depth == 1 && c == ']') {
+						if (lastKey == "Ingredients") inIngredients = false;
+						else if (lastKey == "Keywords") layout.keywords = range;
+						else if (lastKey == "Effects") layout.effects = range;
+					}
+					break;
+				}
+				default:
+					if (depth == 1 && lastKey == "Version" && c >= '0' && c <= '9') {
+						layout.version = 0;
+						for (; i < json.size() && json[i] >= '0' && json[i] <= '9'; ++i)
+							layout.version = layout.version * 10 + $c(unsigned, json[i] - '0');
+						--i;
+						lastKey = {};
+					}
+					break;
+				}
+			}
+			if (!foundIngredients || inIngredients)
+				throw make_exception("Couldn't find the \"Ingredients\" array in registry file!");
+			return layout;
+		}
+
+		/// @brief	Reads the given range of the registry file.
+		static std::string read_range(std::ifstream& file, Range const& range)
+		{
+			std::string buffer($c(std::size_t, range.length), '\0');
+			if (!file.seekg($c(std::streamoff, range.offset)) || !file.read(buffer.data(), $c(std::streamsize, range.length)))
+				throw make_exception("Failed to read bytes [", range.offset, ", ", range.offset + range.length, ") of the registry file!");
+			return buffer;
+		}
+
+	public:
+		/// @brief	Gets the path of the index file for the given registry file.
+		static std::filesystem::path GetIndexPath(std::filesystem::path const& registryPath)
+		{
+			auto path{ registryPath };
+			path += ".index";
+			return path;
+		}
+
+		/// @brief	Checks whether this index was generated from the current version of the given registry file.
+		bool IsValidFor(std::filesystem::path const& registryPath) const
+		{
+			std::error_code ec;
+			const auto size{ std::filesystem::file_size(registryPath, ec) };
+			return !ec && Version == CurrentVersion && size == FileSize && get_file_time(registryPath) == FileTime;
+		}
+
+		/**
+		 * @brief				Generates an index for the given registry file. This reads the whole file.
+		 * @param registryPath	The path to a registry file.
+		 */
+		static RegistryIndex Generate(std::filesystem::path const& registryPath)
+		{
+			RegistryIndex index;
+			index.FileSize = std::filesystem::file_size(registryPath);
+			index.FileTime = get_file_time(registryPath);
+
+			const auto contents{ file::read(registryPath).str() };
+			const auto layout{ scan_layout(contents) };
+			index.SchemaVersion = schema::ToRegistryVersion(layout.version);
+			index.KeywordTable = layout.keywords;
+			index.EffectTable = layout.effects;
+			index.Entries.reserve(layout.ingredients.size());
+			for (const auto& range : layout.ingredients) {
+				Entry entry;
+				entry.offset = range.offset;
+				entry.length = range.length;
+				entry.name = nlohmann::json::parse(contents.begin() + range.offset, contents.begin() + range.offset + range.length).at("name").get<std::string>();
+				std::transform(entry.name.begin(), entry.name.end(), entry.name.begin(), ci::tolower);
+				index.Entries.emplace_back(std::move(entry));
+			}
+			return index;
+		}
+
+		/**
+		 * @brief				Gets the index for the given registry file, generating & saving it when the saved index is missing or out of date.
+		 *						Failing to save the index isn't an error; it will be generated again next time.
+		 * @param registryPath	The path to a registry file.
+		 */
+		static RegistryIndex LoadOrGenerate(std::filesystem::path const& registryPath)
+		{
+			const auto indexPath{ GetIndexPath(registryPath) };
+			if (file::exists(indexPath)) {
+				try {
+					nlohmann::json j;
+					file::read(indexPath) >> j;
+					if (auto index{ j.get<RegistryIndex>() }; index.IsValidFor(registryPath))
+						return index;
+				} catch (const std::exception&) {} //< the index is corrupted; regenerate it
+			}
+
+			auto index{ Generate(registryPath) };
+			file::write(indexPath, nlohmann::json(index));
+			return index;
+		}
+
+		/**
+		 * @brief		Finds an ingredient by name, using the same rules as Registry::find_best_fit with only ingredient names searched.
+		 * @param name	The name to search for. Case is ignored.
+		 * @returns		The index of the matching entry, or std::nullopt when there isn't one.
+		 */
+		std::optional<std::size_t> find_best_fit(std::string_view const name) const
+		{
+			std::optional<std::size_t> partialMatch;
+			for (std::size_t i{ 0 }; i < Entries.size(); ++i) {
+				if (ci::equals(Entries[i].name, name))
+					return i;
+				else if (!partialMatch.has_value() && ci::contains(Entries[i].name, name))
+					partialMatch = i;
+			}
+			return partialMatch;
+		}
+
+		/**
+		 * @brief				Reads only the ingredients that best fit each of the given search terms from a registry file.
+		 *						The result is the same as Registry::ReadFrom(registryPath).find_best_fit(search_terms, true, false).
+		 * @param registryPath	The registry file that this index was generated from.
+		 * @param search_terms	The ingredient names to search for.
+		 * @returns				A registry that contains the best fit for each search term that has one, in the same order as the search terms.
+		 */
+		Registry ReadBestFits(std::filesystem::path const& registryPath, std::vector<std::string> const& search_terms) const
+		{
+			std::ifstream file{ registryPath, std::ios::binary };
+			if (!file.is_open())
+				throw make_exception("Couldn't open registry file ", registryPath, "!");
+
+			// normalized registries also need the keyword & effect tables, which are small compared to the ingredients
+			std::vector<Effect> effectTable;
+			if (SchemaVersion == schema::ERegistryVersion::Normalized)
+				effectTable = schema::ReadEffectTable(nlohmann::json::parse(read_range(file, KeywordTable)), nlohmann::json::parse(read_range(file, EffectTable)));
+
+			Registry registry;
+			registry.Ingredients.reserve(search_terms.size());
+			for (const auto& term : search_terms) {
+				const auto i{ find_best_fit(term) };
+				if (!i.has_value()) continue;
+
+				const nlohmann::json j(nlohmann::json::parse(read_range(file, Entries[i.value()]))); //< brace-initializing a json object would wrap it in an array
+				if (SchemaVersion == schema::ERegistryVersion::Normalized)
+					registry.Ingredients.emplace_back(schema::ReadNormalizedIngredient(j, effectTable));
+				else
+					registry.Ingredients.emplace_back(j.get<Ingredient>());
+			}
+			return registry;
+		}
+	};
+}
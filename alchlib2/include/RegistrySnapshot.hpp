@@ -0,0 +1,127 @@
+#pragma once
+/**
+ * @file	RegistrySnapshot.hpp
+ * @author	radj307
+ * @brief	Immutable, shareable view of a registry for use by concurrent readers.
+ */
+#include "Registry.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace alchlib2 {
+	/**
+	 * @brief	A frozen registry that can be queried from any number of threads at the same time.
+	 *
+	 *			The registry is moved into shared, const storage when the snapshot is created and can never be modified afterwards;
+	 *			copying a snapshot only copies a pointer, and every copy refers to the same registry.
+	 *			None of the query methods have any state of their own, and the lookup structures that they use are each built exactly
+	 *			once (see Registry::GetNameBlob and friends), so no locking is needed by callers.
+	 *
+	 *			Streams returned by stream_if & stream_inclusive_filter refer to the snapshot's registry, so a copy of the snapshot must be
+	 *			kept for as long as they are in use.
+	 *
+	 *			To change a snapshot, get a mutable copy with Thaw(), modify it, then create a new snapshot from it.
+	 */
+	class RegistrySnapshot {
+		std::shared_ptr<const Registry> registry;
+
+	public:
+		using const_iterator = std::vector<Ingredient>::const_iterator;
+
+		/// @brief	Creates an empty snapshot.
+		RegistrySnapshot() : registry{ std::make_shared<const Registry>() } {}
+		/**
+		 * @brief				Freezes the given registry.
+		 * @param registry		The registry to freeze.
+		 * @param buildIndexes	When true, every lookup structure is built now instead of by the first query that needs it.
+		 */
+		explicit RegistrySnapshot(Registry&& registry, const bool buildIndexes = false) : registry{ std::make_shared<const Registry>(std::move(registry)) }
+		{
+			if (buildIndexes)
+				this->registry->build_indexes();
+		}
+		/// @brief	Freezes a copy of the given registry. The copy shares any lookup structures that the registry has already built.
+		explicit RegistrySnapshot(Registry const& registry, const bool buildIndexes = false) : RegistrySnapshot(Registry{ registry }, buildIndexes) {}
+
+		/// @brief	Reads a registry file into a new snapshot.
+		static RegistrySnapshot ReadFrom(std::filesystem::path const& path, const bool buildIndexes = false)
+		{
+			return RegistrySnapshot{ Registry::ReadFrom(path), buildIndexes };
+		}
+
+		/// @brief	Gets the frozen registry, for use with functions that accept a const Registry reference.
+		Registry const& GetRegistry() const noexcept { return *registry; }
+		/// @brief	Gets a mutable copy of the frozen registry. The copy doesn't share lookup structures with the snapshot.
+		Registry Thaw() const
+		{
+			Registry copy{ *registry };
+			copy.invalidate_indexes();
+			return copy;
+		}
+
+	#pragma region VectorInterface
+		std::span<const Ingredient> Ingredients() const noexcept { return registry->Ingredients; }
+		auto begin() const noexcept { return registry->Ingredients.begin(); }
+		auto end() const noexcept { return registry->Ingredients.end(); }
+		auto empty() const noexcept { return registry->Ingredients.empty(); }
+		auto size() const noexcept { return registry->Ingredients.size(); }
+		Ingredient const& at(const size_t& index) const { return registry->Ingredients.at(index); }
+		Ingredient const& operator[](const size_t& index) const { return registry->Ingredients[index]; }
+	#pragma endregion VectorInterface
+
+	#pragma region Indexes
+		NameBlob const& GetNameBlob() const { return registry->GetNameBlob(); }
+		EffectTable const& GetEffectTable() const { return registry->GetEffectTable(); }
+		PairMatrix const& GetPairMatrix() const { return registry->GetPairMatrix(); }
+		EffectIndex const& GetEffectIndex() const { return registry->GetEffectIndex(); }
+		NameCompleter const& GetNameCompleter() const { return registry->GetNameCompleter(); }
+		BKTree const& GetIngredientNameTree() const { return registry->GetIngredientNameTree(); }
+	#pragma endregion Indexes
+
+	#pragma region Queries
+		/// @brief	Gets a copy of the ingredients that match the given predicate. See Registry::copy_if.
+		Registry copy_if(const std::function<bool(Ingredient)>& pred) const
+		{
+			return registry->copy_if(pred);
+		}
+		/// @brief	Gets a copy of the ingredients that match the given search term. See Registry::copy_inclusive_filter.
+		Registry copy_inclusive_filter(std::string_view const search_term, const bool requireExactMatch, const bool searchIngredients, const bool searchEffects = false, const bool searchKeywords = false) const
+		{
+			return registry->copy_inclusive_filter(search_term, requireExactMatch, searchIngredients, searchEffects, searchKeywords);
+		}
+		/// @brief	Gets a lazily-evaluated stream of the ingredients that match the given predicate. See Registry::stream_if.
+		template<typename TPredicate>
+		IngredientStream<TPredicate> stream_if(TPredicate pred) const
+		{
+			return registry->stream_if(std::move(pred));
+		}
+		/// @brief	Gets a lazily-evaluated stream of the ingredients that match the given search term. See Registry::stream_inclusive_filter.
+		IngredientStream<NameFilter> stream_inclusive_filter(std::string_view const search_term, const bool requireExactMatch, const bool searchIngredients, const bool searchEffects = false, const bool searchKeywords = false) const
+		{
+			return registry->stream_inclusive_filter(search_term, requireExactMatch, searchIngredients, searchEffects, searchKeywords);
+		}
+		/// @brief	Finds the ingredient that best fits the given name. See Registry::find_best_fit.
+		const_iterator find_best_fit(std::string_view const name, const bool searchIngredients = true, const bool searchEffects = true) const
+		{
+			return registry->find_best_fit(name, searchIngredients, searchEffects);
+		}
+		/// @brief	Finds the ingredients with names similar to the given name. See Registry::find_similar.
+		std::vector<BKTree::Match> find_similar(std::string_view const name, std::optional<std::size_t> const maxDistance = std::nullopt) const
+		{
+			return registry->find_similar(name, maxDistance);
+		}
+		/// @brief	Finds the ingredient that a misspelled name most likely refers to. See Registry::find_correction.
+		const_iterator find_correction(std::string_view const name) const
+		{
+			return registry->find_correction(name);
+		}
+		/// @brief	Gets a copy of the ingredients that best fit each of the given names. See Registry::find_best_fit.
+		Registry find_best_fit(std::vector<std::string> const& search_terms, const bool searchIngredients = true, const bool searchEffects = true) const
+		{
+			return registry->find_best_fit(search_terms, searchIngredients, searchEffects);
+		}
+	#pragma endregion Queries
+	};
+}
@@ -4,8 +4,14 @@
  * @author	radj307
  * @brief	Adds definitions for the nlohmann json serializer to support custom object types.
  */
+#include <make_exception.hpp>
+
 #include <nlohmann/json.hpp>
 
+#include <map>
+#include <tuple>
+#include <vector>
+
  // Include objects that need serialization support
 #include "INamedObject.hpp"
 #include "EKeywordDisposition.h"
@@ -29,5 +35,147 @@ namespace alchlib2 {
 								 });*/
 	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Effect, name, magnitude, duration, keywords);
 	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Ingredient, name, effects);
-	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Potion, name, effects);
+	inline void to_json(nlohmann::json& j, Potion const& potion)
+	{
+		j = nlohmann::json{ { "name", potion.name }, { "effects", potion.effects } };
+	}
+	/// @brief	Constructs the potion from its name & effects, so that its strongest effect & poison classification are up to date.
+	inline void from_json(nlohmann::json const& j, Potion& potion)
+	{
+		potion = Potion{ j.at("name").get<std::string>(), j.at("effects").get<std::vector<Effect>>() };
+	}
+}
+
+// Registry schema
+namespace alchlib2::schema {
+	/**
+	 * @brief	Registry file schema versions.
+	 *
+	 *			Version 1 (inline) stores every keyword of every effect of every ingredient in full:
+	 *			{ "Ingredients": [ { "name": ..., "effects": [ { "name": ..., "magnitude": ..., "duration": ..., "keywords": [ { "name": ..., "formID": ..., "disposition": ... } ] } ] } ] }
+	 *
+	 *			Version 2 (normalized) stores each unique keyword & effect once, and ingredients reference effects by index:
+	 *			{ "Version": 2,
+	 *			  "Keywords": [ { "name": ..., "formID": ..., "disposition": ... } ],
+	 *			  "Effects": [ { "name": ..., "keywords": [ <keyword index>... ] } ],
+	 *			  "Ingredients": [ { "name": ..., "effects": [ [ <effect index>, <magnitude>, <duration> ]... ] } ] }
+	 */
+	enum class ERegistryVersion : unsigned {
+		Inline = 1,
+		Normalized = 2,
+	};
+	/// @brief	The schema version used when writing registries.
+	inline constexpr ERegistryVersion CurrentRegistryVersion{ ERegistryVersion::Normalized };
+
+	/// @brief	Converts a number to a registry schema version, throwing when the version isn't supported.
+	inline ERegistryVersion ToRegistryVersion(unsigned const version)
+	{
+		if (version != $c(unsigned, ERegistryVersion::Inline) && version != $c(unsigned, ERegistryVersion::Normalized))
+			throw make_exception("Unsupported registry schema version ", version, '!');
+		return $c(ERegistryVersion, version);
+	}
+	/// @brief	Gets the schema version of a registry JSON object. Objects without a "Version" field are version 1.
+	inline ERegistryVersion GetRegistryVersion(nlohmann::json const& j)
+	{
+		return ToRegistryVersion(j.value("Version", $c(unsigned, ERegistryVersion::Inline)));
+	}
+
+	/**
+	 * @brief			Resolves the keyword & effect tables of a version 2 registry.
+	 * @param keywords	The "Keywords" array.
+	 * @param effects	The "Effects" array.
+	 * @returns			One effect per element of the effects table, with its keywords resolved and a magnitude & duration of 0.
+	 */
+	inline std::vector<Effect> ReadEffectTable(nlohmann::json const& keywords, nlohmann::json const& effects)
+	{
+		const auto keywordTable{ keywords.get<std::vector<Keyword>>() };
+
+		std::vector<Effect> effectTable;
+		effectTable.reserve(effects.size());
+		for (const auto& it : effects) {
+			auto& effect{ effectTable.emplace_back(it.at("name").get<std::string>(), 0.0f, 0u) };
+			const auto& keywordIndices{ it.at("keywords") };
+			effect.keywords.reserve(keywordIndices.size());
+			for (const auto& index : keywordIndices)
+				effect.keywords.emplace_back(keywordTable.at(index.get<std::size_t>()));
+		}
+		return effectTable;
+	}
+	/**
+	 * @brief				Reads one ingredient from a version 2 registry.
+	 * @param j				An element of the "Ingredients" array.
+	 * @param effectTable	The result of ReadEffectTable.
+	 */
+	inline Ingredient ReadNormalizedIngredient(nlohmann::json const& j, std::vector<Effect> const& effectTable)
+	{
+		Ingredient ingredient{ j.at("name").get<std::string>() };
+		const auto& effects{ j.at("effects") };
+		ingredient.effects.reserve(effects.size());
+		for (const auto& it : effects) {
+			auto& effect{ ingredient.effects.emplace_back(effectTable.at(it.at(0).get<std::size_t>())) };
+			effect.magnitude = it.at(1).get<float>();
+			effect.duration = it.at(2).get<unsigned>();
+		}
+		return ingredient;
+	}
+
+	/// @brief	Reads the ingredients from a registry JSON object of any supported schema version.
+	inline std::vector<Ingredient> ReadRegistry(nlohmann::json const& j)
+	{
+		switch (GetRegistryVersion(j)) {
+		case ERegistryVersion::Inline:
+			return j.at("Ingredients").get<std::vector<Ingredient>>();
+		case ERegistryVersion::Normalized: {
+			const auto effectTable{ ReadEffectTable(j.at("Keywords"), j.at("Effects")) };
+			const auto& ingredients{ j.at("Ingredients") };
+
+			std::vector<Ingredient> vec;
+			vec.reserve(ingredients.size());
+			for (const auto& it : ingredients)
+				vec.emplace_back(ReadNormalizedIngredient(it, effectTable));
+			return vec;
+		}
+		}
+		return {};
+	}
+
+	/**
+	 * @brief				Converts a list of ingredients to a registry JSON object.
+	 * @param ingredients	The ingredients to write.
+	 * @param version		The schema version to use.
+	 */
+	inline nlohmann::json WriteRegistry(std::vector<Ingredient> const& ingredients, ERegistryVersion const version = CurrentRegistryVersion)
+	{
+		if (version == ERegistryVersion::Inline)
+			return nlohmann::json{ { "Ingredients", ingredients } };
+
+		nlohmann::json keywords(nlohmann::json::value_t::array), effects(nlohmann::json::value_t::array), ingr(nlohmann::json::value_t::array);
+		std::map<std::tuple<std::string, std::string, EKeywordDisposition>, std::size_t> keywordIndices;
+		std::map<std::pair<std::string, std::vector<std::size_t>>, std::size_t> effectIndices;
+
+		for (const auto& ingredient : ingredients) {
+			nlohmann::json effectRefs(nlohmann::json::value_t::array);
+			for (const auto& effect : ingredient.effects) {
+				std::vector<std::size_t> effectKeywords;
+				effectKeywords.reserve(effect.keywords.size());
+				for (const auto& keyword : effect.keywords) {
+					const auto [it, inserted] { keywordIndices.try_emplace({ keyword.name, keyword.formID, keyword.disposition }, keywords.size()) };
+					if (inserted) keywords.emplace_back(keyword);
+					effectKeywords.emplace_back(it->second);
+				}
+
+				const auto [it, inserted] { effectIndices.try_emplace({ effect.name, effectKeywords }, effects.size()) };
+				if (inserted) effects.emplace_back(nlohmann::json{ { "name", effect.name }, { "keywords", effectKeywords } });
+				effectRefs.emplace_back(nlohmann::json::array({ it->second, effect.magnitude, effect.duration }));
+			}
+			ingr.emplace_back(nlohmann::json{ { "name", ingredient.name }, { "effects", std::move(effectRefs) } });
+		}
+
+		return nlohmann::json{
+			{ "Version", $c(unsigned, version) },
+			{ "Keywords", std::move(keywords) },
+			{ "Effects", std::move(effects) },
+			{ "Ingredients", std::move(ingr) },
+		};
+	}
 }
@@ -0,0 +1,120 @@
+#pragma once
+/**
+ * @file	WorkStealingPool.hpp
+ * @author	radj307
+ * @brief	Work-stealing parallel loop for batches of independent tasks with uneven costs.
+ */
+#include <sysarch.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace alchlib2 {
+	/**
+	 * @brief	Runs a batch of indexed tasks on a fixed number of threads.
+	 *
+	 *			Each worker starts with its own contiguous share of the indices, which it takes from the front of its queue in order.
+	 *			A worker whose queue runs dry steals from the back of the other workers' queues, so a few expensive tasks don't leave
+	 *			the other threads idle while one thread finishes its share.
+	 */
+	class WorkStealingPool {
+		struct Queue {
+			std::mutex mutex;
+			std::deque<std::size_t> indices;
+		};
+
+		unsigned threadCount;
+
+		static std::optional<std::size_t> pop_front(Queue& queue)
+		{
+			std::scoped_lock lock{ queue.mutex };
+			if (queue.indices.empty())
+				return std::nullopt;
+			const auto index{ queue.indices.front() };
+			queue.indices.pop_front();
+			return index;
+		}
+		static std::optional<std::size_t> pop_back(Queue& queue)
+		{
+			std::scoped_lock lock{ queue.mutex };
+			if (queue.indices.empty())
+				return std::nullopt;
+			const auto index{ queue.indices.back() };
+			queue.indices.pop_back();
+			return index;
+		}
+
+	public:
+		/// @param threadCount	The number of threads to use, or 0 to use one per hardware thread.
+		WorkStealingPool(unsigned const threadCount = 0) : threadCount{ threadCount == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threadCount } {}
+
+		unsigned thread_count() const noexcept { return threadCount; }
+
+		/**
+		 * @brief		Calls func(i) once for every i in [0, count), and returns once every call has finished.
+		 *				Tasks are never added after the batch starts, so a worker exits as soon as every queue is empty.
+		 * @param count	The number of tasks.
+		 * @param func	A callable with the signature void(std::size_t index). Calls for different indices may run at the same time.
+		 * @throws		The first exception thrown by func, after every thread has stopped. Remaining tasks are skipped.
+		 */
+		template<typename TFunc>
+		void for_each_index(std::size_t const count, TFunc&& func) const
+		{
+			const auto workerCount{ $c(unsigned, std::min<std::size_t>(threadCount, count)) };
+			if (workerCount <= 1) {
+				for (std::size_t i{ 0 }; i < count; ++i)
+					func(i);
+				return;
+			}
+
+			std::vector<std::unique_ptr<Queue>> queues;
+			queues.reserve(workerCount);
+			for (unsigned w{ 0 }; w < workerCount; ++w) {
+				auto& queue{ *queues.emplace_back(std::make_unique<Queue>()) };
+				for (auto i{ count * w / workerCount }, end{ count * (w + 1) / workerCount }; i < end; ++i)
+					queue.indices.emplace_back(i);
+			}
+
+			std::mutex exceptionMutex;
+			std::exception_ptr exception;
+			std::atomic<bool> failed{ false };
+
+			const auto worker{ [&](unsigned const self) {
+				try {
+					while (!failed.load(std::memory_order_relaxed)) {
+						auto index{ pop_front(*queues[self]) };
+						// steal from the other queues, starting with the next one
+						for (unsigned offset{ 1 }; !index.has_value() && offset < workerCount; ++offset)
+							index = pop_back(*queues[(self + offset) % workerCount]);
+						if (!index.has_value())
+							break;
+						func(index.value());
+					}
+				} catch (...) {
+					std::scoped_lock lock{ exceptionMutex };
+					if (!exception)
+						exception = std::current_exception();
+					failed = true;
+				}
+			} };
+
+			{
+				std::vector<std::jthread> threads;
+				threads.reserve(workerCount - 1);
+				for (unsigned w{ 1 }; w < workerCount; ++w)
+					threads.emplace_back(worker, w);
+				worker(0);
+			}
+
+			if (exception)
+				std::rethrow_exception(exception);
+		}
+	};
+}
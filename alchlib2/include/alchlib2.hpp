@@ -2,8 +2,16 @@
 #include "SerializerDefs.h"
 #include "GameSetting.hpp"
 #include "Registry.hpp"
+#include "RegistryIndex.hpp"
+#include "RegistrySnapshot.hpp"
+#include "ConfigWatcher.hpp"
+#include "WorkStealingPool.hpp"
+#include "keywords/KeywordTable.h"
 
 #include "PerkBase.hpp"
 
 #include "Potion.hpp"
 #include "PotionBuilder.hpp"
+#include "RecipeSearch.hpp"
+#include "RecipeDatabase.hpp"
+#include "ProfileSet.hpp"
@@ -0,0 +1,11 @@
+#pragma once
+#include "../Keyword.hpp"
+
+namespace alchlib2::keywords {
+	// Complete Alchemy & Cooking Overhaul
+	inline constexpr KeywordDefinition MagicAlchCureDisease_CACO{ 0x90B902, "MagicAlchCureDisease_CACO", EKeywordDisposition::Cure };
+	inline constexpr KeywordDefinition MagicAlchCurePoison_CACO{ 0x90B903, "MagicAlchCurePoison_CACO", EKeywordDisposition::Cure };
+	inline constexpr KeywordDefinition MagicAlchFatigue_CACO{ 0x07A153, "MagicAlchFatigue_CACO", EKeywordDisposition::Negative };
+	inline constexpr KeywordDefinition MagicAlchDamageMagickaRegen_CACO{ 0x07A152, "MagicAlchDamageMagickaRegen_CACO", EKeywordDisposition::Negative };
+	inline constexpr KeywordDefinition MagicAlchSilence_CACO{ 0x07A150, "MagicAlchSilence_CACO", EKeywordDisposition::Negative };
+}
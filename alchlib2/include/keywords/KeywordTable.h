@@ -0,0 +1,203 @@
+#pragma once
+/**
+ * @file	KeywordTable.h
+ * @author	radj307
+ * @brief	Compile-time table of all known vanilla & CACO keywords, with perfect-hash lookup by form ID and by name.
+ */
+#include "VanillaKeywords.h"
+#include "CACOKeywords.h"
+
+#include <array>
+#include <bit>
+
+namespace alchlib2::keywords {
+	/// @brief	All keywords known at compile time.
+	inline constexpr std::array KnownKeywords{
+		// Vanilla
+		MagicAlchBeneficial,
+		MagicAlchHarmful,
+		MagicAlchDurationBased,
+		MagicAlchRestoreHealth,
+		MagicAlchRestoreStamina,
+		MagicAlchRestoreMagicka,
+		MagicAlchDamageHealth,
+		MagicAlchDamageStamina,
+		MagicAlchDamageMagicka,
+		MagicAlchFortifyHealth,
+		MagicAlchFortifyStamina,
+		MagicAlchFortifyMagicka,
+		MagicAlchFortifyHealRate,
+		MagicAlchFortifyStaminaRate,
+		MagicAlchFortifyMagickaRate,
+		MagicAlchFortifyCarryWeight,
+		MagicAlchFortifyAlteration,
+		MagicAlchFortifyBlock,
+		MagicAlchFortifyOneHanded,
+		MagicAlchFortifyTwoHanded,
+		MagicAlchFortifyMarksman,
+		MagicAlchFortifySmithing,
+		MagicAlchFortifyHeavyArmor,
+		MagicAlchFortifyLightArmor,
+		MagicAlchFortifyPickPocket,
+		MagicAlchFortifyLockpicking,
+		MagicAlchFortifySneak,
+		MagicAlchFortifySpeechcraft,
+		MagicAlchFortifyConjuration,
+		MagicAlchFortifyDestruction,
+		MagicAlchFortifyIllusion,
+		MagicAlchFortifyRestoration,
+		MagicAlchFortifyEnchanting,
+		MagicAlchResistFire,
+		MagicAlchResistFrost,
+		MagicAlchResistShock,
+		MagicAlchResistMagic,
+		MagicAlchResistPoison,
+		MagicAlchWeaknessFire,
+		MagicAlchWeaknessFrost,
+		MagicAlchWeaknessShock,
+		MagicAlchWeaknessMagic,
+		MagicInfluence,
+		MagicInvisibility,
+		MagicNightEye,
+		MagicParalysis,
+		MagicSlow,
+		WISpellColorful,
+		// CACO
+		MagicAlchCureDisease_CACO,
+		MagicAlchCurePoison_CACO,
+		MagicAlchFatigue_CACO,
+		MagicAlchDamageMagickaRegen_CACO,
+		MagicAlchSilence_CACO,
+	};
+
+	namespace detail {
+		/// @brief	64-bit FNV-1a hash of the ASCII-lowercase form of the given string.
+		constexpr std::uint64_t hash_name(std::string_view const name) noexcept
+		{
+			std::uint64_t h{ 0xCBF29CE484222325ull };
+			for (const char c : name) {
+				h ^= $c(std::uint8_t, (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+				h *= 0x100000001B3ull;
+			}
+			return h;
+		}
+		constexpr std::uint64_t hash_formID(std::uint32_t const formID) noexcept
+		{
+			return formID;
+		}
+
+		/**
+		 * @brief		A perfect hash over a fixed set of keys, mapping each key to a unique slot.
+		 * @tparam N	The number of keys. Must be less than 255.
+		 * @tparam Bits	log2 of the number of slots.
+		 */
+		template<std::size_t N, unsigned Bits>
+		struct PerfectHash {
+			static_assert(N < 0xFF, "PerfectHash stores indices in a single byte!");
+
+			std::uint64_t seed{};
+			/// @brief	0 for an empty slot, otherwise the key's index + 1.
+			std::array<std::uint8_t, (std::size_t{ 1 } << Bits)> slots{};
+
+			static constexpr std::size_t slot_of(std::uint64_t const hash, std::uint64_t const seed) noexcept
+			{
+				return $c(std::size_t, ((hash ^ seed) * 0x9E3779B97F4A7C15ull) >> (64u - Bits));
+			}
+
+			/**
+			 * @brief		Gets the index of the only key that could have the given hash.
+			 * @param hash	The hash of the key to look up.
+			 * @returns		The candidate index, which must still be compared with the key; or std::nullopt when no key can match.
+			 */
+			constexpr std::optional<std::size_t> probe(std::uint64_t const hash) const noexcept
+			{
+				if (const auto slot{ slots[slot_of(hash, seed)] }; slot != 0)
+					return slot - 1u;
+				return std::nullopt;
+			}
+		};
+
+		/// @brief	Searches for a seed that maps all of the given hashes to unique slots. This is only ever evaluated at compile time.
+		template<unsigned Bits, std::size_t N>
+		consteval PerfectHash<N, Bits> make_perfect_hash(std::array<std::uint64_t, N> const& hashes)
+		{
+			PerfectHash<N, Bits> ph;
+			for (std::uint64_t seed{ 1 }; seed < 0x10000; ++seed) {
+				ph.seed = seed;
+				ph.slots = {};
+				bool collision{ false };
+				for (std::size_t i{ 0 }; i < N && !collision; ++i) {
+					auto& slot{ ph.slots[PerfectHash<N, Bits>::slot_of(hashes[i], seed)] };
+					if (slot != 0)
+						collision = true;
+					else slot = $c(std::uint8_t, i + 1);
+				}
+				if (!collision)
+					return ph;
+			}
+			throw "Failed to find a perfect hash seed; duplicate keys or too few slots!";
+		}
+
+		/// @brief	Uses 8 slots per key so that a collision-free seed is found quickly.
+		inline constexpr unsigned KnownKeywordsHashBits{ std::bit_width(std::bit_ceil(KnownKeywords.size()) * 8u) - 1u };
+
+		inline constexpr auto KnownKeywordsByName{ make_perfect_hash<KnownKeywordsHashBits>([] {
+			std::array<std::uint64_t, KnownKeywords.size()> hashes{};
+			for (std::size_t i{ 0 }; i < KnownKeywords.size(); ++i)
+				hashes[i] = hash_name(KnownKeywords[i].name);
+			return hashes;
+		}()) };
+		inline constexpr auto KnownKeywordsByFormID{ make_perfect_hash<KnownKeywordsHashBits>([] {
+			std::array<std::uint64_t, KnownKeywords.size()> hashes{};
+			for (std::size_t i{ 0 }; i < KnownKeywords.size(); ++i)
+				hashes[i] = hash_formID(KnownKeywords[i].formID);
+			return hashes;
+		}()) };
+	}
+
+	/**
+	 * @brief			Finds the known keyword with the given form ID in constant time.
+	 * @param formID	A numeric form ID.
+	 * @returns			A pointer to the keyword's definition when it is known; otherwise nullptr.
+	 */
+	constexpr KeywordDefinition const* FindKeyword(std::uint32_t const formID) noexcept
+	{
+		if (const auto index{ detail::KnownKeywordsByFormID.probe(detail::hash_formID(formID)) }; index.has_value() && KnownKeywords[index.value()].formID == formID)
+			return &KnownKeywords[index.value()];
+		return nullptr;
+	}
+	/**
+	 * @brief		Finds the known keyword with the given (case-insensitive) editor ID in constant time.
+	 * @param name	A keyword editor ID, such as "MagicAlchHarmful".
+	 * @returns		A pointer to the keyword's definition when it is known; otherwise nullptr.
+	 */
+	constexpr KeywordDefinition const* FindKeyword(std::string_view const name) noexcept
+	{
+		if (const auto index{ detail::KnownKeywordsByName.probe(detail::hash_name(name)) }; index.has_value() && ci::equals(KnownKeywords[index.value()].name, name))
+			return &KnownKeywords[index.value()];
+		return nullptr;
+	}
+	/**
+	 * @brief			Finds the known keyword that matches the given Keyword's form ID in constant time.
+	 * @param keyword	A Keyword instance.
+	 * @returns			A pointer to the keyword's definition when it is known; otherwise nullptr.
+	 */
+	constexpr KeywordDefinition const* FindKeyword(Keyword const& keyword) noexcept
+	{
+		if (const auto formID{ ParseFormID(keyword.formID) }; formID.has_value())
+			return FindKeyword(formID.value());
+		return FindKeyword(std::string_view{ keyword.name });
+	}
+
+	/**
+	 * @brief			Gets the disposition of the given keyword, preferring the compile-time table over the registry's value.
+	 * @param keyword	A Keyword instance.
+	 * @returns			The keyword's disposition.
+	 */
+	constexpr EKeywordDisposition GetDisposition(Keyword const& keyword) noexcept
+	{
+		if (const auto* def{ FindKeyword(keyword) }; def != nullptr)
+			return def->disposition;
+		return keyword.disposition;
+	}
+}
@@ -2,10 +2,60 @@
 #include "../Keyword.hpp"
 
 namespace alchlib2::keywords {
-	inline static const Keyword MagicAlchBeneficial{ "MagicAlchBeneficial", "0F8A4E", (EKeywordDisposition)2 };
-	inline static const Keyword MagicAlchRestoreHealth{ "MagicAlchRestoreHealth", "042503", (EKeywordDisposition)2 };
-	inline static const Keyword MagicAlchRestoreStamina{ "MagicAlchRestoreStamina", "042504", (EKeywordDisposition)2 };
-	inline static const Keyword MagicAlchRestoreMagicka{ "MagicAlchRestoreMagicka", "042508", (EKeywordDisposition)2 };
-	inline static const Keyword MagicAlchHarmful{ "MagicAlchHarmful", "042509", (EKeywordDisposition)16 };
-	inline static const Keyword MagicAlchDurationBased{ "MagicAlchDurationBased", "0F8A4F", (EKeywordDisposition)1 };
+	// Potion/Poison
+	inline constexpr KeywordDefinition MagicAlchBeneficial{ 0x0F8A4E, "MagicAlchBeneficial", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchHarmful{ 0x042509, "MagicAlchHarmful", EKeywordDisposition::Negative };
+	inline constexpr KeywordDefinition MagicAlchDurationBased{ 0x0F8A4F, "MagicAlchDurationBased", EKeywordDisposition::Neutral };
+	// Restore
+	inline constexpr KeywordDefinition MagicAlchRestoreHealth{ 0x042503, "MagicAlchRestoreHealth", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchRestoreStamina{ 0x042504, "MagicAlchRestoreStamina", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchRestoreMagicka{ 0x042508, "MagicAlchRestoreMagicka", EKeywordDisposition::Positive };
+	// Damage
+	inline constexpr KeywordDefinition MagicAlchDamageHealth{ 0x10F9DD, "MagicAlchDamageHealth", EKeywordDisposition::Negative };
+	inline constexpr KeywordDefinition MagicAlchDamageStamina{ 0x10F9DC, "MagicAlchDamageStamina", EKeywordDisposition::Negative };
+	inline constexpr KeywordDefinition MagicAlchDamageMagicka{ 0x10F9DE, "MagicAlchDamageMagicka", EKeywordDisposition::Negative };
+	// Fortify Attribute
+	inline constexpr KeywordDefinition MagicAlchFortifyHealth{ 0x065A31, "MagicAlchFortifyHealth", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchFortifyStamina{ 0x065A32, "MagicAlchFortifyStamina", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchFortifyMagicka{ 0x065A33, "MagicAlchFortifyMagicka", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchFortifyHealRate{ 0x065A30, "MagicAlchFortifyHealRate", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyStaminaRate{ 0x065A35, "MagicAlchFortifyStaminaRate", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchFortifyMagickaRate{ 0x065A34, "MagicAlchFortifyMagickaRate", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchFortifyCarryWeight{ 0x065A2F, "MagicAlchFortifyCarryWeight", EKeywordDisposition::FortifyStat };
+	// Fortify Skill
+	inline constexpr KeywordDefinition MagicAlchFortifyAlteration{ 0x065A1D, "MagicAlchFortifyAlteration", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyBlock{ 0x065A1E, "MagicAlchFortifyBlock", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyOneHanded{ 0x065A1F, "MagicAlchFortifyOneHanded", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyTwoHanded{ 0x065A20, "MagicAlchFortifyTwoHanded", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyMarksman{ 0x065A21, "MagicAlchFortifyMarksman", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifySmithing{ 0x065A22, "MagicAlchFortifySmithing", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyHeavyArmor{ 0x065A23, "MagicAlchFortifyHeavyArmor", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyLightArmor{ 0x065A24, "MagicAlchFortifyLightArmor", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyPickPocket{ 0x065A25, "MagicAlchFortifyPickPocket", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyLockpicking{ 0x065A26, "MagicAlchFortifyLockpicking", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifySneak{ 0x065A27, "MagicAlchFortifySneak", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifySpeechcraft{ 0x065A29, "MagicAlchFortifySpeechcraft", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyConjuration{ 0x065A2A, "MagicAlchFortifyConjuration", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyDestruction{ 0x065A2B, "MagicAlchFortifyDestruction", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyIllusion{ 0x065A2C, "MagicAlchFortifyIllusion", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyRestoration{ 0x065A2D, "MagicAlchFortifyRestoration", EKeywordDisposition::FortifyStat };
+	inline constexpr KeywordDefinition MagicAlchFortifyEnchanting{ 0x065A2E, "MagicAlchFortifyEnchanting", EKeywordDisposition::FortifyStat };
+	// Resist
+	inline constexpr KeywordDefinition MagicAlchResistFire{ 0x065A37, "MagicAlchResistFire", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchResistFrost{ 0x065A38, "MagicAlchResistFrost", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchResistShock{ 0x065A39, "MagicAlchResistShock", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchResistMagic{ 0x065A3A, "MagicAlchResistMagic", EKeywordDisposition::Positive };
+	inline constexpr KeywordDefinition MagicAlchResistPoison{ 0x10EB5F, "MagicAlchResistPoison", EKeywordDisposition::Positive };
+	// Weakness
+	inline constexpr KeywordDefinition MagicAlchWeaknessFire{ 0x074F4E, "MagicAlchWeaknessFire", EKeywordDisposition::Negative };
+	inline constexpr KeywordDefinition MagicAlchWeaknessFrost{ 0x074F4F, "MagicAlchWeaknessFrost", EKeywordDisposition::Negative };
+	inline constexpr KeywordDefinition MagicAlchWeaknessShock{ 0x074F50, "MagicAlchWeaknessShock", EKeywordDisposition::Negative };
+	inline constexpr KeywordDefinition MagicAlchWeaknessMagic{ 0x074F51, "MagicAlchWeaknessMagic", EKeywordDisposition::Negative };
+	// Other
+	inline constexpr KeywordDefinition MagicInfluence{ 0x078098, "MagicInfluence", EKeywordDisposition::InfluenceOther };
+	inline constexpr KeywordDefinition MagicInvisibility{ 0x01EA6F, "MagicInvisibility", EKeywordDisposition::Neutral };
+	inline constexpr KeywordDefinition MagicNightEye{ 0x0AD7C6, "MagicNightEye", EKeywordDisposition::Neutral };
+	inline constexpr KeywordDefinition MagicParalysis{ 0x01EA70, "MagicParalysis", EKeywordDisposition::Negative };
+	inline constexpr KeywordDefinition MagicSlow{ 0x0B729E, "MagicSlow", EKeywordDisposition::Negative };
+	inline constexpr KeywordDefinition WISpellColorful{ 0x0A9B1E, "WISpellColorful", EKeywordDisposition::Neutral };
 }
@@ -24,7 +24,7 @@ namespace alchlib2::perks {
 			potion.ModAllMagnitudes(0.2f * $c(float, rank));
 		}
 
-		NLOHMANN_DEFINE_TYPE_INTRUSIVE(AlchemistPerk, name, rank);
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(AlchemistPerk, name, enable, rank);
 	};
 	struct PhysicianPerk : PerkBase {
 		static constexpr const auto Name{ "Physician" };
@@ -38,7 +38,7 @@ namespace alchlib2::perks {
 			}
 		}
 
-		NLOHMANN_DEFINE_TYPE_INTRUSIVE(PhysicianPerk, name);
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(PhysicianPerk, name, enable);
 	};
 	struct BenefactorPerk : PerkBase {
 		static constexpr const auto Name{ "Benefactor" };
@@ -53,7 +53,7 @@ namespace alchlib2::perks {
 			}
 		}
 
-		NLOHMANN_DEFINE_TYPE_INTRUSIVE(BenefactorPerk, name);
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(BenefactorPerk, name, enable);
 	};
 	struct PoisonerPerk : PerkBase {
 		static constexpr const auto Name{ "Poisoner" };
@@ -67,7 +67,7 @@ namespace alchlib2::perks {
 			}
 		}
 
-		NLOHMANN_DEFINE_TYPE_INTRUSIVE(PoisonerPerk, name);
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(PoisonerPerk, name, enable);
 	};
 	struct PurityPerk : PerkBase {
 		static constexpr const auto Name{ "Purity" };
@@ -77,12 +77,12 @@ namespace alchlib2::perks {
 		void ApplyToPotion(Potion& potion) const noexcept override
 		{
 			if (potion.IsPoison())
-				potion.effects.erase(std::remove_if(potion.effects.begin(), potion.effects.end(), [](auto&& effect) { return effect.HasAnyKeyword(alchlib2::keywords::MagicAlchBeneficial); }), potion.effects.end());
+				potion.RemoveEffectsIf([](auto&& effect) { return effect.HasAnyKeyword(alchlib2::keywords::MagicAlchBeneficial); });
 			else
-				potion.effects.erase(std::remove_if(potion.effects.begin(), potion.effects.end(), [](auto&& effect) { return effect.HasAnyKeyword(alchlib2::keywords::MagicAlchHarmful); }), potion.effects.end());
+				potion.RemoveEffectsIf([](auto&& effect) { return effect.HasAnyKeyword(alchlib2::keywords::MagicAlchHarmful); });
 		}
 
-		NLOHMANN_DEFINE_TYPE_INTRUSIVE(PurityPerk, name);
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(PurityPerk, name, enable);
 	};
 
 	struct VanillaPerks {
@@ -92,7 +92,7 @@ namespace alchlib2::perks {
 		PoisonerPerk Poisoner;
 		PurityPerk Purity;
 
-		NLOHMANN_DEFINE_TYPE_INTRUSIVE(VanillaPerks, Alchemist, Physician, Benefactor, Poisoner, Purity);
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(VanillaPerks, Alchemist, Physician, Benefactor, Poisoner, Purity);
 
 		std::vector<Perk> GetAllPerks() const
 		{
@@ -117,7 +117,7 @@ namespace alchlib2::perks {
 		}
 		static bool WriteTo(std::filesystem::path const& path, VanillaPerks const& perks)
 		{
-			return file::write(path, nlohmann::json{ perks });
+			return file::write(path, nlohmann::json(perks));
 		}
 	};
 }
\ No newline at end of file
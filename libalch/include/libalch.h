@@ -0,0 +1,198 @@
+#pragma once
+/**
+ * @file	libalch.h
+ * @author	radj307
+ * @brief	C API for embedding alchlib2 in other programs.
+ *
+ *			Every object is accessed through an opaque handle that is created by an alch_*_open or query function, and must be
+ *			released with the matching alch_*_close or alch_*_free function. Strings are returned by copying them into
+ *			caller-provided buffers.
+ *
+ *			Functions that can fail return an alch_status. When a function returns anything other than ALCH_OK, a description of
+ *			the error can be retrieved with alch_last_error() on the same thread.
+ *
+ *			Thread safety:
+ *			- alch_registry handles are immutable once opened, and may be queried from any number of threads at the same time.
+ *			- alch_settings handles may be shared between threads as long as none of them call alch_settings_set_game_settings.
+ *			- alch_results, alch_completions & alch_potion handles are immutable, and may be read from any number of threads at the same time.
+ */
+#include <stddef.h>
+
+#if defined(_WIN32)
+#	ifdef LIBALCH_EXPORTS
+#		define LIBALCH_API __declspec(dllexport)
+#	else
+#		define LIBALCH_API __declspec(dllimport)
+#	endif
+#else
+#	define LIBALCH_API __attribute__((visibility("default")))
+#endif
+
+/// @brief	Incremented whenever a function is removed or its signature changes. Adding functions does not change it.
+#define LIBALCH_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	typedef enum alch_status {
+		ALCH_OK = 0,
+		/// @brief	A required pointer was NULL, an index was out of range, or too few names were given.
+		ALCH_ERROR_INVALID_ARGUMENT = 1,
+		/// @brief	A file couldn't be read or parsed.
+		ALCH_ERROR_LOAD_FAILED = 2,
+		/// @brief	No ingredient matched a name that was required to match one.
+		ALCH_ERROR_NOT_FOUND = 3,
+		/// @brief	The buffer was too small. As much of the string as fits was written, and the required size was returned.
+		ALCH_ERROR_BUFFER_TOO_SMALL = 4,
+		/// @brief	Any other error.
+		ALCH_ERROR_INTERNAL = 5,
+	} alch_status;
+
+	/// @brief	An ingredient registry.
+	typedef struct alch_registry alch_registry;
+	/// @brief	Game settings & perks used when building potions.
+	typedef struct alch_settings alch_settings;
+	/// @brief	A list of ingredients returned by a query.
+	typedef struct alch_results alch_results;
+	/// @brief	A potion returned by alch_build.
+	typedef struct alch_potion alch_potion;
+	/// @brief	A list of names returned by alch_complete.
+	typedef struct alch_completions alch_completions;
+
+	/// @brief	The kind of object that a completed name belongs to. See ENameKind.
+	typedef enum alch_name_kind {
+		ALCH_NAME_INGREDIENT = 0,
+		ALCH_NAME_EFFECT = 1,
+		ALCH_NAME_KEYWORD = 2,
+	} alch_name_kind;
+
+	/// @brief	The game settings used by the alchemy formula. See AlchemyCoreGameSettings.
+	typedef struct alch_game_settings {
+		float ingredient_init_mult;
+		float skill_factor;
+		/// @brief	The alchemy skill level.
+		float alchemy_av;
+		/// @brief	The alchemy skill modifier, from fortify alchemy effects.
+		float alchemy_mod;
+	} alch_game_settings;
+
+	/// @brief	The numeric data of an ingredient's or potion's effect. The name is returned separately.
+	typedef struct alch_effect_info {
+		float magnitude;
+		unsigned duration;
+		/// @brief	The effect's EKeywordDisposition.
+		unsigned disposition;
+	} alch_effect_info;
+
+	/// @brief	Gets LIBALCH_API_VERSION from the loaded library.
+	LIBALCH_API unsigned alch_api_version(void);
+	/// @brief	Gets the description of the last error that occurred on the calling thread. The string is valid until the next call on the same thread.
+	LIBALCH_API const char* alch_last_error(void);
+
+	/**
+	 * @brief		Reads a registry file, and builds its name completion index.
+	 * @param path	The path of the registry file. Both registry schema versions are supported.
+	 * @param out	Receives the registry handle. Release it with alch_registry_close.
+	 */
+	LIBALCH_API alch_status alch_registry_open(const char* path, alch_registry** out);
+	/// @brief	Releases a registry handle. Results that were returned by queries on it remain valid. Passing NULL does nothing.
+	LIBALCH_API void alch_registry_close(alch_registry* registry);
+	/// @brief	Gets the number of ingredients in a registry.
+	LIBALCH_API size_t alch_registry_size(const alch_registry* registry);
+
+	/**
+	 * @brief					Reads the game settings & perks configs.
+	 * @param gameSettingsPath	The path of the game settings config, or NULL to use the default game settings.
+	 * @param perksPath			The path of the perks config, or NULL to use the default perks.
+	 * @param out				Receives the settings handle. Release it with alch_settings_close.
+	 */
+	LIBALCH_API alch_status alch_settings_open(const char* gameSettingsPath, const char* perksPath, alch_settings** out);
+	/// @brief	Releases a settings handle. Passing NULL does nothing.
+	LIBALCH_API void alch_settings_close(alch_settings* settings);
+	LIBALCH_API alch_status alch_settings_get_game_settings(const alch_settings* settings, alch_game_settings* out);
+	LIBALCH_API alch_status alch_settings_set_game_settings(alch_settings* settings, const alch_game_settings* gameSettings);
+
+	/**
+	 * @brief		Finds every ingredient whose name, or any of whose effect names, matches the search term. This is the same as alch2's search mode.
+	 * @param exact	When nonzero, names must equal the search term; otherwise they must contain it. Case is always ignored.
+	 * @param out	Receives the results handle. Release it with alch_results_free.
+	 */
+	LIBALCH_API alch_status alch_search(const alch_registry* registry, const char* term, int exact, alch_results** out);
+	/**
+	 * @brief		Finds every ingredient that has an effect matching each of the given effect names. This is the same as alch2's smart search mode.
+	 * @param exact	When nonzero, effect names must equal each search term; otherwise they must contain it. Case is always ignored.
+	 * @param out	Receives the results handle. Release it with alch_results_free.
+	 */
+	LIBALCH_API alch_status alch_smart_search(const alch_registry* registry, const char* const* effects, size_t count, int exact, alch_results** out);
+	/**
+	 * @brief		Finds the ingredient that best fits each of the given names, which are the ingredients alch_build would combine.
+	 *				A name that doesn't match any ingredient is corrected to the closest ingredient name, like alch2's build mode does.
+	 *				Names that can't be corrected are skipped.
+	 * @param out	Receives the results handle, with at most one ingredient per name, in the same order as the names. Release it with alch_results_free.
+	 */
+	LIBALCH_API alch_status alch_best_fit(const alch_registry* registry, const char* const* names, size_t count, alch_results** out);
+	/**
+	 * @brief			Combines the ingredients that best fit each of the given names into a potion. This is the same as alch2's build mode.
+	 *					A name that doesn't match any ingredient is corrected to the closest ingredient name.
+	 * @param settings	The game settings & perks to use, or NULL to use the defaults.
+	 * @param out		Receives the potion handle. Release it with alch_potion_free.
+	 * @returns			ALCH_ERROR_INVALID_ARGUMENT when fewer than 2 names are given, or ALCH_ERROR_NOT_FOUND when a name doesn't match any
+	 *					ingredient and can't be corrected.
+	 */
+	LIBALCH_API alch_status alch_build(const alch_registry* registry, const alch_settings* settings, const char* const* names, size_t count, alch_potion** out);
+
+	/**
+	 * @brief			Finds the ingredient, effect & keyword names that have a word beginning with the given prefix. This is the same as alch2's complete mode.
+	 * @param prefix	The prefix to complete. Case is ignored. An empty prefix matches every name.
+	 * @param limit		The maximum number of names to return, or 0 for no limit.
+	 * @param out		Receives the completions handle, with the best completions first. Release it with alch_completions_free.
+	 */
+	LIBALCH_API alch_status alch_complete(const alch_registry* registry, const char* prefix, size_t limit, alch_completions** out);
+
+	/// @brief	Releases a results handle. Passing NULL does nothing.
+	LIBALCH_API void alch_results_free(alch_results* results);
+	/// @brief	Gets the number of ingredients in a results list.
+	LIBALCH_API size_t alch_results_count(const alch_results* results);
+	/**
+	 * @brief			Copies the name of an ingredient in a results list.
+	 * @param buffer	The buffer to copy the null-terminated name into. May be NULL when bufferSize is 0.
+	 * @param required	When not NULL, receives the buffer size that the name requires, including the null terminator.
+	 */
+	LIBALCH_API alch_status alch_results_ingredient_name(const alch_results* results, size_t index, char* buffer, size_t bufferSize, size_t* required);
+	/// @brief	Gets the number of effects that an ingredient in a results list has.
+	LIBALCH_API size_t alch_results_effect_count(const alch_results* results, size_t index);
+	/**
+	 * @brief			Gets an effect of an ingredient in a results list.
+	 * @param info		When not NULL, receives the effect's numeric data.
+	 * @param buffer	The buffer to copy the null-terminated effect name into. May be NULL when bufferSize is 0.
+	 * @param required	When not NULL, receives the buffer size that the name requires, including the null terminator.
+	 */
+	LIBALCH_API alch_status alch_results_effect(const alch_results* results, size_t index, size_t effectIndex, alch_effect_info* info, char* buffer, size_t bufferSize, size_t* required);
+
+	/// @brief	Releases a completions handle. Passing NULL does nothing.
+	LIBALCH_API void alch_completions_free(alch_completions* completions);
+	/// @brief	Gets the number of names in a completions list.
+	LIBALCH_API size_t alch_completions_count(const alch_completions* completions);
+	/**
+	 * @brief			Gets a name in a completions list.
+	 * @param kind		When not NULL, receives the kind of object that the name belongs to.
+	 * @param count		When not NULL, receives the number of ingredients that have the name.
+	 * @param buffer	The buffer to copy the null-terminated name into. See alch_results_ingredient_name for the buffer semantics.
+	 */
+	LIBALCH_API alch_status alch_completions_get(const alch_completions* completions, size_t index, alch_name_kind* kind, unsigned* count, char* buffer, size_t bufferSize, size_t* required);
+
+	/// @brief	Releases a potion handle. Passing NULL does nothing.
+	LIBALCH_API void alch_potion_free(alch_potion* potion);
+	/// @brief	Copies the name of a potion. See alch_results_ingredient_name for the buffer semantics.
+	LIBALCH_API alch_status alch_potion_name(const alch_potion* potion, char* buffer, size_t bufferSize, size_t* required);
+	/// @brief	Gets the number of effects that a potion has.
+	LIBALCH_API size_t alch_potion_effect_count(const alch_potion* potion);
+	/// @brief	Gets an effect of a potion. See alch_results_effect for the parameter semantics.
+	LIBALCH_API alch_status alch_potion_effect(const alch_potion* potion, size_t effectIndex, alch_effect_info* info, char* buffer, size_t bufferSize, size_t* required);
+	/// @brief	Gets whether a potion is a poison (nonzero) or not (zero).
+	LIBALCH_API int alch_potion_is_poison(const alch_potion* potion);
+
+#ifdef __cplusplus
+}
+#endif
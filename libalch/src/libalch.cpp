@@ -0,0 +1,381 @@
+#include "libalch.h"
+
+#include <alchlib2.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+struct alch_registry {
+	alchlib2::RegistrySnapshot registry;
+};
+struct alch_settings {
+	alchlib2::AlchemyCoreGameSettings gameSettings;
+	std::vector<alchlib2::Perk> perks;
+};
+struct alch_results {
+	std::vector<alchlib2::Ingredient> ingredients;
+};
+struct alch_potion {
+	alchlib2::Potion potion;
+};
+struct alch_completions {
+	struct Completion {
+		std::string name;
+		alchlib2::ENameKind kind;
+		std::uint32_t count;
+	};
+	std::vector<Completion> completions;
+};
+
+namespace {
+	thread_local std::string lastError;
+
+	/// @brief	Thrown to return a specific status from a guarded function.
+	struct status_error : std::exception {
+		alch_status status;
+		std::string message;
+		status_error(alch_status const status, std::string message) : status{ status }, message{ std::move(message) } {}
+		const char* what() const noexcept override { return message.c_str(); }
+	};
+
+	/// @brief	Calls the given function, converting any exception it throws into a status code & error message, since exceptions can't cross the C API.
+	template<typename TFunc>
+	alch_status guard(TFunc&& func) noexcept
+	{
+		try {
+			func();
+			return ALCH_OK;
+		} catch (const status_error& ex) {
+			lastError = ex.message;
+			return ex.status;
+		} catch (const std::bad_alloc&) {
+			lastError = "Out of memory!";
+			return ALCH_ERROR_INTERNAL;
+		} catch (const std::exception& ex) {
+			lastError = ex.what();
+			return ALCH_ERROR_INTERNAL;
+		} catch (...) {
+			lastError = "An undefined exception occurred!";
+			return ALCH_ERROR_INTERNAL;
+		}
+	}
+
+	template<typename T>
+	void require(T const* ptr, const char* name)
+	{
+		if (ptr == nullptr)
+			throw status_error{ ALCH_ERROR_INVALID_ARGUMENT, str::stringify("Argument '", name, "' must not be NULL!") };
+	}
+
+	std::vector<std::string> to_strings(const char* const* strings, size_t const count)
+	{
+		if (count != 0)
+			require(strings, "names");
+		std::vector<std::string> vec;
+		vec.reserve(count);
+		for (size_t i{ 0 }; i < count; ++i) {
+			require(strings[i], "names[i]");
+			vec.emplace_back(strings[i]);
+		}
+		return vec;
+	}
+
+	/// @brief	Copies a string into a caller-provided buffer, truncating it when the buffer is too small.
+	alch_status copy_string(std::string const& str, char* buffer, size_t const bufferSize, size_t* required) noexcept
+	{
+		if (required != nullptr)
+			*required = str.size() + 1;
+		if (bufferSize != 0 && buffer != nullptr) {
+			const auto count{ std::min(str.size(), bufferSize - 1) };
+			std::memcpy(buffer, str.data(), count);
+			buffer[count] = '\0';
+		}
+		if (bufferSize < str.size() + 1) {
+			lastError = "The buffer is too small!";
+			return ALCH_ERROR_BUFFER_TOO_SMALL;
+		}
+		return ALCH_OK;
+	}
+
+	/// @brief	Gets an effect's numeric data & copies its name into a caller-provided buffer.
+	alch_status get_effect(std::vector<alchlib2::Effect> const& effects, size_t const effectIndex, alch_effect_info* info, char* buffer, size_t const bufferSize, size_t* required) noexcept
+	{
+		if (effectIndex >= effects.size()) {
+			lastError = "Effect index is out of range!";
+			return ALCH_ERROR_INVALID_ARGUMENT;
+		}
+		const auto& effect{ effects[effectIndex] };
+		if (info != nullptr) {
+			info->magnitude = effect.magnitude;
+			info->duration = effect.duration;
+			info->disposition = $c(unsigned, effect.GetDisposition());
+		}
+		return copy_string(effect.name, buffer, bufferSize, required);
+	}
+
+	/// @brief	Finds the ingredient that best fits a name, or the ingredient that a misspelled name most likely refers to, like alch2's build mode.
+	alchlib2::RegistrySnapshot::const_iterator find_ingredient(alchlib2::RegistrySnapshot const& registry, std::string const& name)
+	{
+		if (const auto it{ registry.find_best_fit(name, true, false) }; it != registry.end())
+			return it;
+		return registry.find_correction(name);
+	}
+
+	/// @brief	Gets the perks used when no settings handle is given.
+	std::vector<alchlib2::Perk> const& get_default_perks()
+	{
+		static const auto perks{ alchlib2::perks::VanillaPerks{}.GetAllPerks() };
+		return perks;
+	}
+
+	template<typename T>
+	void reset_output(T** out)
+	{
+		require(out, "out");
+		*out = nullptr;
+	}
+}
+
+extern "C" {
+	unsigned alch_api_version(void) { return LIBALCH_API_VERSION; }
+	const char* alch_last_error(void) { return lastError.c_str(); }
+
+#pragma region Registry
+	alch_status alch_registry_open(const char* path, alch_registry** out)
+	{
+		return guard([&] {
+			reset_output(out);
+			require(path, "path");
+			if (!file::exists(path))
+				throw status_error{ ALCH_ERROR_LOAD_FAILED, str::stringify("Couldn't find a registry file at \"", path, "\"!") };
+
+			alchlib2::Registry registry;
+			try {
+				registry = alchlib2::Registry::ReadFrom(path);
+			} catch (const std::exception& ex) {
+				throw status_error{ ALCH_ERROR_LOAD_FAILED, ex.what() };
+			}
+			auto handle{ std::make_unique<alch_registry>(alchlib2::RegistrySnapshot{ std::move(registry) }) };
+			// build the completion index now, so that the first alch_complete call is as fast as the rest
+			handle->registry.GetNameCompleter();
+			*out = handle.release();
+		});
+	}
+	void alch_registry_close(alch_registry* registry)
+	{
+		delete registry;
+	}
+	size_t alch_registry_size(const alch_registry* registry)
+	{
+		return registry == nullptr ? 0 : registry->registry.size();
+	}
+#pragma endregion Registry
+
+#pragma region Settings
+	alch_status alch_settings_open(const char* gameSettingsPath, const char* perksPath, alch_settings** out)
+	{
+		return guard([&] {
+			reset_output(out);
+			auto settings{ std::make_unique<alch_settings>() };
+			try {
+				if (gameSettingsPath != nullptr)
+					settings->gameSettings = alchlib2::AlchemyCoreGameSettings::ReadFrom(gameSettingsPath);
+				settings->perks = (perksPath == nullptr ? alchlib2::perks::VanillaPerks{} : alchlib2::perks::VanillaPerks::ReadFrom(perksPath)).GetAllPerks();
+			} catch (const std::exception& ex) {
+				throw status_error{ ALCH_ERROR_LOAD_FAILED, ex.what() };
+			}
+			*out = settings.release();
+		});
+	}
+	void alch_settings_close(alch_settings* settings)
+	{
+		delete settings;
+	}
+	alch_status alch_settings_get_game_settings(const alch_settings* settings, alch_game_settings* out)
+	{
+		return guard([&] {
+			require(settings, "settings");
+			require(out, "out");
+			out->ingredient_init_mult = settings->gameSettings.fAlchemyIngredientInitMult.value;
+			out->skill_factor = settings->gameSettings.fAlchemySkillFactor.value;
+			out->alchemy_av = settings->gameSettings.fAlchemyAV.value;
+			out->alchemy_mod = settings->gameSettings.fAlchemyMod.value;
+		});
+	}
+	alch_status alch_settings_set_game_settings(alch_settings* settings, const alch_game_settings* gameSettings)
+	{
+		return guard([&] {
+			require(settings, "settings");
+			require(gameSettings, "gameSettings");
+			settings->gameSettings.fAlchemyIngredientInitMult.value = gameSettings->ingredient_init_mult;
+			settings->gameSettings.fAlchemySkillFactor.value = gameSettings->skill_factor;
+			settings->gameSettings.fAlchemyAV.value = gameSettings->alchemy_av;
+			settings->gameSettings.fAlchemyMod.value = gameSettings->alchemy_mod;
+		});
+	}
+#pragma endregion Settings
+
+#pragma region Queries
+	alch_status alch_search(const alch_registry* registry, const char* term, int exact, alch_results** out)
+	{
+		return guard([&] {
+			reset_output(out);
+			require(registry, "registry");
+			require(term, "term");
+			*out = new alch_results{ registry->registry.copy_inclusive_filter(term, exact != 0, true, true).Ingredients };
+		});
+	}
+	alch_status alch_smart_search(const alch_registry* registry, const char* const* effects, size_t count, int exact, alch_results** out)
+	{
+		return guard([&] {
+			reset_output(out);
+			require(registry, "registry");
+			const auto names{ to_strings(effects, count) };
+			const bool requireExactMatch{ exact != 0 };
+			*out = new alch_results{ registry->registry.copy_if([&names, requireExactMatch](alchlib2::Ingredient const& ingredient) {
+				return std::all_of(names.begin(), names.end(), [&ingredient, requireExactMatch](auto&& name) { return ingredient.AnyEffectIsSimilarTo(name, requireExactMatch); });
+			}).Ingredients };
+		});
+	}
+	alch_status alch_best_fit(const alch_registry* registry, const char* const* names, size_t count, alch_results** out)
+	{
+		return guard([&] {
+			reset_output(out);
+			require(registry, "registry");
+			std::vector<alchlib2::Ingredient> ingredients;
+			ingredients.reserve(count);
+			for (const auto& name : to_strings(names, count))
+				if (const auto it{ find_ingredient(registry->registry, name) }; it != registry->registry.end())
+					ingredients.emplace_back(*it);
+			*out = new alch_results{ std::move(ingredients) };
+		});
+	}
+	alch_status alch_build(const alch_registry* registry, const alch_settings* settings, const char* const* names, size_t count, alch_potion** out)
+	{
+		return guard([&] {
+			reset_output(out);
+			require(registry, "registry");
+			const auto strings{ to_strings(names, count) };
+			if (strings.size() < 2)
+				throw status_error{ ALCH_ERROR_INVALID_ARGUMENT, "Not enough ingredients were specified. (Min 2)" };
+
+			std::vector<alchlib2::Ingredient> ingredients;
+			ingredients.reserve(strings.size());
+			for (const auto& name : strings) {
+				const auto it{ find_ingredient(registry->registry, name) };
+				if (it == registry->registry.end())
+					throw status_error{ ALCH_ERROR_NOT_FOUND, str::stringify("Couldn't find an ingredient matching \"", name, "\"!") };
+				ingredients.emplace_back(*it);
+			}
+
+			// the builder only keeps a reference to the game settings, so they must outlive it
+			const auto gameSettings{ settings == nullptr ? alchlib2::AlchemyCoreGameSettings{} : settings->gameSettings };
+			const alchlib2::PotionBuilder builder{ gameSettings };
+			auto potion{ builder.Build(ingredients, settings == nullptr ? get_default_perks() : settings->perks) };
+			*out = new alch_potion{ std::move(potion) };
+		});
+	}
+	alch_status alch_complete(const alch_registry* registry, const char* prefix, size_t limit, alch_completions** out)
+	{
+		return guard([&] {
+			reset_output(out);
+			require(registry, "registry");
+			require(prefix, "prefix");
+			auto completions{ std::make_unique<alch_completions>() };
+			for (const auto& completion : registry->registry.GetNameCompleter().complete(prefix, limit))
+				completions->completions.emplace_back(alch_completions::Completion{ std::string{ completion.name }, completion.kind, completion.count });
+			*out = completions.release();
+		});
+	}
+#pragma endregion Queries
+
+#pragma region Results
+	void alch_results_free(alch_results* results)
+	{
+		delete results;
+	}
+	size_t alch_results_count(const alch_results* results)
+	{
+		return results == nullptr ? 0 : results->ingredients.size();
+	}
+	alch_status alch_results_ingredient_name(const alch_results* results, size_t index, char* buffer, size_t bufferSize, size_t* required)
+	{
+		if (results == nullptr || index >= results->ingredients.size()) {
+			lastError = "Invalid results handle or ingredient index!";
+			return ALCH_ERROR_INVALID_ARGUMENT;
+		}
+		return copy_string(results->ingredients[index].name, buffer, bufferSize, required);
+	}
+	size_t alch_results_effect_count(const alch_results* results, size_t index)
+	{
+		return results == nullptr || index >= results->ingredients.size() ? 0 : results->ingredients[index].effects.size();
+	}
+	alch_status alch_results_effect(const alch_results* results, size_t index, size_t effectIndex, alch_effect_info* info, char* buffer, size_t bufferSize, size_t* required)
+	{
+		if (results == nullptr || index >= results->ingredients.size()) {
+			lastError = "Invalid results handle or ingredient index!";
+			return ALCH_ERROR_INVALID_ARGUMENT;
+		}
+		return get_effect(results->ingredients[index].effects, effectIndex, info, buffer, bufferSize, required);
+	}
+#pragma endregion Results
+
+#pragma region Completions
+	void alch_completions_free(alch_completions* completions)
+	{
+		delete completions;
+	}
+	size_t alch_completions_count(const alch_completions* completions)
+	{
+		return completions == nullptr ? 0 : completions->completions.size();
+	}
+	alch_status alch_completions_get(const alch_completions* completions, size_t index, alch_name_kind* kind, unsigned* count, char* buffer, size_t bufferSize, size_t* required)
+	{
+		if (completions == nullptr || index >= completions->completions.size()) {
+			lastError = "Invalid completions handle or index!";
+			return ALCH_ERROR_INVALID_ARGUMENT;
+		}
+		const auto& completion{ completions->completions[index] };
+		if (kind != nullptr)
+			*kind = $c(alch_name_kind, completion.kind);
+		if (count != nullptr)
+			*count = completion.count;
+		return copy_string(completion.name, buffer, bufferSize, required);
+	}
+#pragma endregion Completions
+
+#pragma region Potion
+	void alch_potion_free(alch_potion* potion)
+	{
+		delete potion;
+	}
+	alch_status alch_potion_name(const alch_potion* potion, char* buffer, size_t bufferSize, size_t* required)
+	{
+		if (potion == nullptr) {
+			lastError = "Argument 'potion' must not be NULL!";
+			return ALCH_ERROR_INVALID_ARGUMENT;
+		}
+		return copy_string(potion->potion.name, buffer, bufferSize, required);
+	}
+	size_t alch_potion_effect_count(const alch_potion* potion)
+	{
+		return potion == nullptr ? 0 : potion->potion.effects.size();
+	}
+	alch_status alch_potion_effect(const alch_potion* potion, size_t effectIndex, alch_effect_info* info, char* buffer, size_t bufferSize, size_t* required)
+	{
+		if (potion == nullptr) {
+			lastError = "Argument 'potion' must not be NULL!";
+			return ALCH_ERROR_INVALID_ARGUMENT;
+		}
+		return get_effect(potion->potion.effects, effectIndex, info, buffer, bufferSize, required);
+	}
+	int alch_potion_is_poison(const alch_potion* potion)
+	{
+		return potion != nullptr && potion->potion.IsPoison();
+	}
+#pragma endregion Potion
+}